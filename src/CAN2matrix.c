@@ -25,19 +25,33 @@
 
 #include "can/can_mcp2515.h"
 #include "adc/adc.h"
-#include "comm/comm_matrix.h"
 #include "leds/leds.h"
 #include "timer/timer.h"
 //#include "uart/uart.h"
+#include "adc_io/adc_sample.h"
+#include "can_io/can_filter.h"
+#include "can_io/can_rx.h"
+#include "can_io/can_tx.h"
+#include "can_io/can_fault.h"
+#include "can_io/mcp2515_spi.h"
+#include "sched/scheduler.h"
+#include "sched/timebase.h"
+#include "sched/idle.h"
+#include "sched/profile.h"
+#include "comm/comm_matrix.h"
+#include "comm/comm_sleep.h"
+#include "comm/comm_tx.h"
 #include "CAN2matrix.h"
 
-//! counter to evaluate timing to send CAN messages
-volatile uint8_t send_it         = 0;
-//! flag to send tick to instrument cluster
-volatile bool    trigger50ms     = false;
 //! current state of FSM
 volatile state_t fsmState        = INIT;
 
+//! time of the wake up interrupt (lower 16bit of timebase_get())
+volatile uint16_t wakeStart      = 0;
+
+//! statistics of waking up from sleep
+wake_stats_t wakeStats;
+
 /**
  * \brief main loop
  * \returns nothing, since the main loop does not end until power off
@@ -53,13 +67,24 @@ int __attribute__((OS_main)) main(void)
 #endif
 {
    initHardware();
+   initSchedule();
+   // signal matrix from EEPROM, if valid
+   comm_matrix_load();
+   // values known before power off, so the first CAN2 frames are plausible
+   comm_matrix_restore();
 
    if (true == initCAN())
    {
-      // start timers and enable ADC
-      startTimer1();
+      // start timer and enable ADC
       startTimer2();
       adc_enable();
+      // receive CAN frames by interrupt, send without blocking
+      can_rx_enable(CAN_CHIP1);
+      can_rx_enable(CAN_CHIP2);
+      can_tx_init(CAN_CHIP1);
+      can_tx_init(CAN_CHIP2);
+      comm_tx_init();
+      comm_sleep_init();
       // start normal operation
       fsmState = RUNNING;
 
@@ -75,6 +100,7 @@ int __attribute__((OS_main)) main(void)
             case RUNNING:
             {
                run();
+               enterIdle();
                break;
             }
 
@@ -96,8 +122,8 @@ int __attribute__((OS_main)) main(void)
             {
                sleeping();
                // set state WAKEUP here, too avoid race conditions
-               // with pending interrupt
-               fsmState = WAKEUP;
+               // with pending interrupt - unless no wake id is received
+               fsmState = (true == checkWakeUp()) ? WAKEUP : SLEEPING;
                break;
             }
 
@@ -129,12 +155,19 @@ int __attribute__((OS_main)) main(void)
 void sleepDetected()
 {
    // stop timer for now
-   stopTimer1();
    stopTimer2();
 
    // stop adc to save power
+   adc_sample_stop();
    adc_disable();
 
+   // no more reception by interrupt, INT0 is used for wake up from now on
+   can_rx_disable(CAN_CHIP1);
+   can_rx_disable(CAN_CHIP2);
+
+   // keep slow signals over power off (EEPROM, only if changed)
+   comm_matrix_save();
+
 #ifdef ___TEST_TX_ABORT__
    // abort any pending CAN frames to be transmitted on CAN
    can_abort_all_transmissions(CAN_CHIP1);
@@ -143,9 +176,6 @@ void sleepDetected()
    can_abort_all_transmissions(CAN_CHIP2);
 #endif
 
-   // (re)set global flags
-   send_it  = 0;
-
    // put MCP25* to sleep for CAN2 and activate after activity on CAN1
    // This has to be done before master CAN goes to sleep, because
    // the clock of the slave chip may be taken from master CAN chip's
@@ -154,6 +184,13 @@ void sleepDetected()
    // wait for SPI
    _delay_ms(1);
 
+   // only wake ids are received while sleeping (see checkWakeUp())
+   can_filter_initWake(CAN_CHIP1);
+   // frames passed by the normal filters would wake the gateway at once
+   mcp2515_spi_bitModify(CAN_CHIP1, MCP_REG_CANINTF,
+                         (1 << MCP_RX0IF) | (1 << MCP_RX1IF), 0);
+   mcp2515_spi_forget(CAN_CHIP1);
+
    // put MCP2515 to sleep and wait for activity interrupt
    mcp2515_sleep(CAN_CHIP1, INT_SLEEP_WAKEUP_BY_CAN);
 
@@ -198,30 +235,107 @@ void sleeping()
    GICR  &= ~(EXTERNAL_INT0_ENABLE);
 }
 
+/**
+ * @brief check whether CAN1 is to wake the gateway (selective wake up)
+ *
+ * The frame waking the MCP2515 is lost, so the ones following are awaited
+ * up to WAKE_CHECK_MS. While sleeping only the wake ids pass the filters
+ * (see can_filter_initWake()), so any frame received is one. Otherwise
+ * CAN1 is put to sleep again and the wake up is counted as spurious.
+ *
+ * @return true if the gateway is to wake up. Otherwise false is returned.
+ */
+bool checkWakeUp()
+{
+   uint32_t start = timebase_get();
+   uint32_t time;
+
+   mcp2515_wakeup(CAN_CHIP1, INT_SLEEP_WAKEUP_BY_CAN);
+   if(false == wakeCanChip(CAN_CHIP1))
+   {
+      // recovered after the full wake up
+      return true;
+   }
+
+   do
+   {
+      if(0 != (mcp2515_spi_rxStatus(CAN_CHIP1) & MCP_RX_STATUS_MSG_MASK))
+      {
+         return true;
+      }
+      time = timebase_get() - start;
+   }
+   while(time < TIMEBASE_US2TICKS(WAKE_CHECK_MS * 1000UL));
+
+   // nothing to do, back to sleep
+   mcp2515_spi_forget(CAN_CHIP1);
+   mcp2515_sleep(CAN_CHIP1, INT_SLEEP_WAKEUP_BY_CAN);
+
+   if(UINT16_MAX != wakeStats.spurious)
+   {
+      ++wakeStats.spurious;
+   }
+   wakeStats.spuriousTime += time;
+
+   return false;
+}
+
 /**
  * @brief wake up CAN and reinitialize the timers
  *
  * Now the AVR has woken up. Timers needs to be restarted, ADC to be enabled
  * again and the CAN controllers will also need to enter their working mode.
+ * CAN1 is awake since checkWakeUp() and gets its filters back, CAN2 is
+ * polled until it is in normal mode, instead of waiting a fixed time.
+ * Then all CAN2 messages are sent at once from the values
+ * stored before sleep (see comm_tx_burst()), the time from INT0 until then
+ * is kept in wakeStats.
  */
 void wakeUp()
 {
+   uint16_t latency;
+
    cli();
-   // wakeup all CAN busses
-   mcp2515_wakeup(CAN_CHIP1, INT_SLEEP_WAKEUP_BY_CAN);
-   // wait a little for the CAN controller to be ready (Tosc * 128)
-   _delay_ms(1);
+   // CAN1 is awake already (see checkWakeUp()), all ids pass again
+   if(false == can_filter_init(CAN_CHIP1))
+   {
+      can_fault_failed(CAN_CHIP1);
+   }
+   // ready as soon as its oscillator runs (Tosc * 128)
    mcp2515_wakeup(CAN_CHIP2, INT_SLEEP_MANUAL_WAKEUP);
-   // wait a little for the CAN controller to be ready (Tosc * 128)
-   _delay_ms(1);
+   wakeCanChip(CAN_CHIP2);
 
-   restartTimer1();
    restartTimer2();
 
    adc_enable();
 
+   // receive CAN frames by interrupt again, nothing left to send
+   can_rx_enable(CAN_CHIP1);
+   can_rx_enable(CAN_CHIP2);
+   can_tx_init(CAN_CHIP1);
+   can_tx_init(CAN_CHIP2);
+   comm_tx_init();
+   // ignition state unknown until decoded again
+   comm_sleep_init();
+
    sei();
 
+   // full state for the radio at once, cycles go on afterwards
+   if(0 != comm_tx_burst())
+   {
+      latency = (uint16_t)timebase_get() - wakeStart;
+      wakeStats.latencyLast = latency;
+      if(latency > wakeStats.latencyMax)
+      {
+         wakeStats.latencyMax = latency;
+      }
+      led_toggle(txCan2LED);
+   }
+   if(UINT16_MAX != wakeStats.count)
+   {
+      ++wakeStats.count;
+   }
+
    // debugging ;-)
    led_on(sleepLed);
 }
@@ -232,48 +346,32 @@ void wakeUp()
 void run()
 {
    can_t msg;
-   can_error_t error;
 
    /**** GET MESSAGES FROM CAN1 ***********************************/
 
+   PROFILE_BEGIN(PROFILE_CAN1_RECEPTION);
    handleCan1Reception(&msg);
-   _delay_ms(1);
+   PROFILE_END(PROFILE_CAN1_RECEPTION);
 
    /**** PUT MESSAGES TO CAN2 *************************************/
 
+   PROFILE_BEGIN(PROFILE_CAN2_TRANSMISSION);
    handleCan2Transmission(&msg);
-   _delay_ms(1);
+   PROFILE_END(PROFILE_CAN2_TRANSMISSION);
 
    /**** GET MESSAGES FROM CAN2 ***********************************/
 
+   PROFILE_BEGIN(PROFILE_CAN2_RECEPTION);
    handleCan2Reception(&msg);
-   _delay_ms(1);
+   PROFILE_END(PROFILE_CAN2_RECEPTION);
 
    /**** PUT MESSAGES TO CAN1 *************************************/
 
    handleCan1Transmission(&msg);
-   _delay_ms(1);
 
-   /**** CHECK CAN STATUS *****************************************/
-   error = can_get_general_bus_errors(CAN_CHIP1);
-   if(CAN_ERR_NO_ERROR == error)
-   {
-      led_off(errCan1LED);
-   }
-   else
-   {
-      led_on(errCan1LED);
-   }
+   /**** COUNT SPI TRANSACTIONS (STATUS: checkCanStatus()) ********/
 
-   error = can_get_general_bus_errors(CAN_CHIP2);
-   if(CAN_ERR_NO_ERROR == error)
-   {
-      led_off(errCan2LED);
-   }
-   else
-   {
-      led_on(errCan2LED);
-   }
+   mcp2515_spi_countPass();
 }
 
 /**
@@ -284,14 +382,19 @@ void run()
  */
 void errorState()
 {
+   uint32_t nextToggle;
+
    // error handling, e.g. init failed
-   stopTimer1();
    restartTimer2();     // may be stopped, due to sleep mode
+   // interrupts may not be enabled yet, if init failed
+   sei();
+
+   nextToggle = sched_getTicks();
    while (1)
    {
-      if (0 == (trigger50ms % 10))  // approx. 500ms
+      if ((int32_t)(sched_getTicks() - nextToggle) >= 0)
       {
-         trigger50ms = false;
+         nextToggle += SCHED_MS2TICKS(500);
          led_toggle(sleepLed);
       }
    }
@@ -316,42 +419,81 @@ void initHardware()
    // init LED output
    led_init();
 
-   // set timer for bussleep detection
-   initTimer1(TimerCompare);
-
    // set timer for CAN 100ms trigger
    initTimer2(TimerCompare);
 
+   // free running timebase for timestamps
+   timebase_init();
+
+#ifdef PROFILE_ENABLE
+   // cycle counter of the profiling probes
+   profile_init();
+#endif
+
    // initialize the hardware SPI with default values set in spi/spi_config.h
    spi_pin_init();
    spi_master_init();
 
-   // initialize adc
+   // initialize adc, oversampled by interrupt
    adc_init();
+   adc_sample_init();
 
    // initialize uart
 //   uart_init();
 
-   // set wakeup interrupt trigger on low level
+   // set wakeup/reception interrupt trigger on low level
    MCUCR |= EXTERNAL_INT0_TRIGGER;
+   // set reception interrupt trigger of CAN2 on low level
+   MCUCR |= EXTERNAL_INT1_TRIGGER;
+}
+
+/**
+ * @brief Register all periodic jobs
+ *
+ * This is the one place for any periodic work. CAN2 messages are not
+ * scheduled here, they are sent by their transmit policy (see comm_tx.h).
+ *
+ * \code
+ * job                     period   phase
+ * sampleDimValue            50ms     0ms
+ * checkCanStatus            25ms     0ms
+ * mcp2515_spi_sampleRate  1000ms    25ms
+ * idle_sample             1000ms    75ms
+ * checkBusSleep            100ms    50ms
+ * \endcode
+ */
+void initSchedule()
+{
+   sched_register(sampleDimValue,
+                  SCHED_MS2TICKS(50),   SCHED_MS2TICKS(0));
+   sched_register(checkCanStatus,
+                  SCHED_MS2TICKS(25),   SCHED_MS2TICKS(0));
+   sched_register(mcp2515_spi_sampleRate,
+                  SCHED_MS2TICKS(MCP_SPI_RATE_PERIOD_MS), SCHED_MS2TICKS(25));
+   sched_register(idle_sample,
+                  SCHED_MS2TICKS(IDLE_SAMPLE_PERIOD_MS), SCHED_MS2TICKS(75));
+   sched_register(checkBusSleep,
+                  SCHED_MS2TICKS(COMM_SLEEP_PERIOD_MS), SCHED_MS2TICKS(50));
 }
 
 /**
  * @brief Initialize the CAN controllers
  *
  * Calls can_init_mcp2515 for each attached CAN controller and setting up
- * bit rate. If an error occurs some status LEDs will indicate it.
+ * bit rate. If an error occurs some status LEDs will indicate it. A failing
+ * CAN2 controller is taken off the bus and initialized again later (see
+ * can_fault.h), so the gateway keeps working on the CAN1 side.
  *
  * See chapter \ref page_can_bus for further details.
  *
- * @return true if all is ok. Otherwise false is returned.
+ * @return true if CAN1 is ok. Otherwise false is returned.
  */
 bool initCAN()
 {
    bool retVal = true;
 
    // init can interface 1
-   if (false == can_init_mcp2515(CAN_CHIP1, CAN_BITRATE_100_KBPS, NORMAL_MODE))
+   if (false == initCanChip(CAN_CHIP1))
    {
       // signal error on initialization
       led_on(errCan1LED);
@@ -360,11 +502,11 @@ bool initCAN()
    // wait for SPI
    _delay_ms(1);
    // init can interface 2
-   if (false == can_init_mcp2515(CAN_CHIP2, CAN_BITRATE_125_KBPS, NORMAL_MODE))
+   if (false == initCanChip(CAN_CHIP2))
    {
-      // signal error on initialization
+      // signal error on initialization, retried by checkCanStatus()
       led_on(errCan2LED);
-      retVal = false;
+      can_fault_failed(CAN_CHIP2);
    }
 
    return retVal;
@@ -376,61 +518,201 @@ bool initCAN()
 /***************************************************************************/
 
 /**
- * @brief interrupt service routine for Timer1 capture
+ * @brief interrupt service routine for Timer2 compare
  *
- * Timer1 input capture interrupt (~15s 4MHz@1024 prescale factor)
+ * Timer2 compare match interrupt handler --> set as 25ms scheduler tick
  **/
-ISR(TIMER1_CAPT_vect)
+ISR(TIMER2_COMP_vect)
 {
-   fsmState = SLEEP_DETECTED;
+   idle_wake();
+   sched_tick();
 }
 
 /**
- * @brief interrupt service routine for Timer2 compare
+ * @brief interrupt service routine for Timer0 overflow
  *
- * Timer2 compare match interrupt handler --> set as 25ms (4x25ms = 100ms)
+ * Timer0 overflow interrupt handler --> extends the free running timebase
+ * (~4ms 4MHz@64 prescale factor)
  **/
-ISR(TIMER2_COMP_vect)
+ISR(TIMER0_OVF_vect)
 {
-   ++send_it;
-   trigger50ms = (0 == (send_it % 2));   // ~50ms;
+   timebase_overflow();
+}
+
+/**
+ * @brief interrupt service routine for ADC conversion complete
+ *
+ * Sums up a burst of oversampled conversions (see adc_sample.h). No work
+ * for the main loop until the burst is done, so no idle_wake().
+ **/
+ISR(ADC_vect)
+{
+   adc_sample_complete();
 }
 
 /**
  * @brief interrupt service routine for external interrupt 0
  *
- * External Interrupt0 handler to wake up from CAN activity
+ * External Interrupt0 handler to wake up from CAN activity. While running
+ * it fetches the received frames of CAN1, while sleeping it notes the time
+ * of waking up.
  **/
 ISR(INT0_vect)
 {
-   // needs to be here, even if empty
+   idle_wake();
+   if(RUNNING == fsmState)
+   {
+      can_rx_fetch(CAN_CHIP1);
+   }
+   else if(SLEEPING == fsmState)
+   {
+      wakeStart = (uint16_t)timebase_get();
+   }
+}
+
+/**
+ * @brief interrupt service routine for external interrupt 1
+ *
+ * External Interrupt1 handler to fetch the received frames of CAN2.
+ **/
+ISR(INT1_vect)
+{
+   idle_wake();
+   can_rx_fetch(CAN_CHIP2);
 }
 
 /***************************************************************************/
 /* HELPER ROUTINES                                                         */
 /***************************************************************************/
 
+/**
+ * @brief initialize a CAN controller with its bit rate and filters
+ * @param chip - selected MCP2515
+ * @return true if all is ok. Otherwise false is returned.
+ */
+bool initCanChip(eChipSelect chip)
+{
+   // registers are reset by the CAN module
+   mcp2515_spi_forget(chip);
+
+   return can_init_mcp2515(chip,
+                           (CAN_CHIP1 == chip) ? CAN_BITRATE_100_KBPS
+                                               : CAN_BITRATE_125_KBPS,
+                           NORMAL_MODE) &&
+          can_filter_init(chip);
+}
+
+/**
+ * @brief wait for a CAN controller woken up to be in normal mode
+ * @param chip - selected MCP2515
+ * @return true if the controller is ready. Otherwise false is returned.
+ *
+ * A controller not ready in time is taken off the bus and initialized
+ * again later (see can_fault.h).
+ */
+bool wakeCanChip(eChipSelect chip)
+{
+   if(false == mcp2515_spi_setMode(chip, MCP_OPMOD_NORMAL))
+   {
+      can_fault_failed(chip);
+      if(UINT8_MAX != wakeStats.failed)
+      {
+         ++wakeStats.failed;
+      }
+      return false;
+   }
+
+   return true;
+}
+
+/**
+ * @brief initialize a CAN controller again after bus off
+ * @param chip - selected MCP2515
+ *
+ * Reception, transmission and, for CAN2, the cycles of the sent messages
+ * start over. Reception stays disabled, if the initialization failed.
+ * Called by checkCanStatus() within can_rx_lock().
+ */
+void recoverCan(eChipSelect chip)
+{
+   bool success = initCanChip(chip);
+
+   if(true == success)
+   {
+      can_rx_enable(chip);
+   }
+   else
+   {
+      // chip in unknown state - no interrupt until the next attempt
+      can_rx_disable(chip);
+   }
+   can_tx_init(chip);
+   if (CAN_CHIP2 == chip)
+   {
+      comm_tx_init();
+   }
+
+   can_fault_recovered(chip, success);
+}
+
+/**
+ * @brief sleep in idle mode until the next interrupt, if there is no work
+ *
+ * Only sleeps, if no frame is received or to be sent, no scheduler tick is
+ * pending and the next CAN2 message is due after IDLE_MAX_TIME. Sends due
+ * earlier are polled for by the main loop.
+ */
+void enterIdle()
+{
+   if((comm_tx_timeToNext() <= IDLE_MAX_TIME) ||
+      (false == can_tx_isIdle(CAN_CHIP1)) ||
+      (false == can_tx_isIdle(CAN_CHIP2)))
+   {
+      return;
+   }
+
+   // no interrupt may set any work between the check and sleeping
+   cli();
+   if((RUNNING == fsmState) &&
+      (false == can_rx_isPending(CAN_CHIP1)) &&
+      (false == can_rx_isPending(CAN_CHIP2)) &&
+      (false == sched_isPending()))
+   {
+      // returns with interrupts enabled
+      idle_sleep();
+   }
+   sei();
+}
+
 /**
  * @brief handles CAN1 reception
  * @param msg - pointer to message struct
  */
 void handleCan1Reception(can_t* msg)
 {
-   if (can_check_message_received(CAN_CHIP1))
-   {
-      // try to read message
-      if (can_get_message(CAN_CHIP1, msg))
-      {
-         // reset timer counter, since there is activity on master CAN bus
-         setTimer1Count(0);
+   uint8_t frames = 0;
 
-         // fetch information from CAN1
-         fetchInfoFromCAN1(msg);
+   // process all frames queued by INT0
+   while (can_rx_get(CAN_CHIP1, msg))
+   {
+      ++frames;
 
-         // signal activity
-         led_toggle(rxCan1LED);
+      // fetch information from CAN1, anything else passed the filters
+      if (false == fetchInfoFromCAN1(msg))
+      {
+         can_rx_countUnwanted(CAN_CHIP1);
+      }
+      else
+      {
+         // activity on master CAN bus keeps it awake
+         comm_sleep_activity(msg->msgId);
       }
+
+      // signal activity
+      led_toggle(rxCan1LED);
    }
+
+   can_rx_countPass(CAN_CHIP1, frames);
 }
 
 /**
@@ -439,16 +721,20 @@ void handleCan1Reception(can_t* msg)
  */
 void handleCan2Reception(can_t* msg)
 {
-   // empty read buffers and get information
-   if (can_check_message_received(CAN_CHIP2))
+   uint8_t frames = 0;
+
+   // process all frames queued by INT1
+   while (can_rx_get(CAN_CHIP2, msg))
    {
-      // try to read message
-      if (can_get_message(CAN_CHIP2, msg))
+      ++frames;
+      // fetch information from CAN2, anything else passed the filters
+      if (false == fetchInfoFromCAN2(msg))
       {
-         // fetch information from CAN2
-         fetchInfoFromCAN2(msg);
+         can_rx_countUnwanted(CAN_CHIP2);
       }
    }
+
+   can_rx_countPass(CAN_CHIP2, frames);
 }
 
 /**
@@ -458,24 +744,115 @@ void handleCan2Reception(can_t* msg)
 void handleCan1Transmission(can_t* msg)
 {
    // handle reset trigger wisely, when putting in some code here!
+
+   // load queued frames into free transmit buffers
+   can_tx_service(CAN_CHIP1);
 }
 
 /**
  * @brief handle CAN2 transmission
  * @param msg - pointer to message struct
+ *
+ * Runs the periodic jobs (see initSchedule()) and sends the CAN2 messages
+ * due by cycle or changed content (see comm_tx_run()).
  */
 void handleCan2Transmission(can_t* msg)
 {
-   if(true == trigger50ms)
+   sched_run();
+
+   if(0 != comm_tx_run())
    {
-      trigger50ms = false;
       // signal activity
       led_toggle(txCan2LED);
-      sendCan2(msg);
-      // sample and set dim value
-      uint16_t dimValue = adc_get();
+   }
+
+   // load queued frames into free transmit buffers
+   can_tx_service(CAN_CHIP2);
+}
+
+/**
+ * @brief check error flags and receive overflows of both CAN chips
+ *
+ * One EFLG read per chip. The flags are latched by the MCP2515, so a
+ * periodic check loses no overflow and keeps the main loop pass free of
+ * SPI transfers, if there is nothing to receive or send. Error passive and
+ * bus off change the transmission (see can_fault.h), a chip bus off for
+ * CAN_FAULT_RECOVERY_MS is initialized again.
+ */
+void checkCanStatus()
+{
+   uint8_t eflg;
+
+   PROFILE_BEGIN(PROFILE_CAN_STATUS);
+   can_rx_lock();
+
+   eflg = can_rx_checkOverflow(CAN_CHIP1);
+   if(true == can_fault_check(CAN_CHIP1, eflg))
+   {
+      recoverCan(CAN_CHIP1);
+      // flags read before the re-init are void
+      eflg = mcp2515_spi_readRegister(CAN_CHIP1, MCP_REG_EFLG);
+   }
+   if((0 == (eflg & MCP_EFLG_ERRORS)) &&
+      (CAN_FAULT_BUS_OFF != can_fault_getStats(CAN_CHIP1)->state))
+   {
+      led_off(errCan1LED);
+   }
+   else
+   {
+      led_on(errCan1LED);
+   }
+
+   eflg = can_rx_checkOverflow(CAN_CHIP2);
+   if(true == can_fault_check(CAN_CHIP2, eflg))
+   {
+      recoverCan(CAN_CHIP2);
+      // flags read before the re-init are void
+      eflg = mcp2515_spi_readRegister(CAN_CHIP2, MCP_REG_EFLG);
+   }
+   if((0 == (eflg & MCP_EFLG_ERRORS)) &&
+      (CAN_FAULT_BUS_OFF != can_fault_getStats(CAN_CHIP2)->state))
+   {
+      led_off(errCan2LED);
+   }
+   else
+   {
+      led_on(errCan2LED);
+   }
+
+   can_rx_unlock();
+   PROFILE_END(PROFILE_CAN_STATUS);
+}
+
+/**
+ * @brief set dim value oversampled and start the next burst
+ *
+ * Takes the value decimated by the ADC interrupt since the last call, if
+ * any. Nobody waits for a conversion.
+ */
+void sampleDimValue()
+{
+   uint16_t dimValue;
+
+   if(true == adc_sample_get(&dimValue))
+   {
       setDimValue(dimValue);
    }
+   adc_sample_start();
+}
+
+/**
+ * @brief detect sleep of the master CAN bus
+ *
+ * The quiet time until sleep depends on the ignition state (see
+ * comm_sleep.h). Replaces the fixed ~15s of Timer1.
+ */
+void checkBusSleep()
+{
+   if(true == comm_sleep_run())
+   {
+      fsmState = SLEEP_DETECTED;
+   }
 }
 
 
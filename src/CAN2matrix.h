@@ -45,6 +45,30 @@ typedef enum
    ERROR          = 5
 } state_t;
 
+/**
+ * @brief statistics of waking up from sleep
+ *
+ * Times are in units of timebase_get(), which stands still while sleeping.
+ * So spuriousTime is the time awake for nothing while parked. The average
+ * current parked is the sleep current plus the awake current times
+ * spuriousTime per hour parked, read out with the time parked.
+ */
+typedef struct
+{
+   //! wake ups, saturating
+   uint16_t count;
+   //! wake ups without a wake id received (see checkWakeUp()), saturating
+   uint16_t spurious;
+   //! time spent awake for spurious wake ups
+   uint32_t spuriousTime;
+   //! last time from INT0 until the CAN2 burst is queued
+   uint16_t latencyLast;
+   //! longest time from INT0 until the CAN2 burst is queued
+   uint16_t latencyMax;
+   //! CAN controllers not ready in time, saturating
+   uint8_t  failed;
+} wake_stats_t;
+
 /***************************************************************************/
 /* DEFINITIONS                                                             */
 /***************************************************************************/
@@ -78,8 +102,11 @@ typedef enum
  *     1     0 The falling edge of INT1 generates an interrupt request
  *     1     1 The rising edge of INT1 generates an interrupt request
  * \endcode
+ *
+ * The MCP2515 keeps its INT pin low as long as frames are pending, so the
+ * low level is used for reception.
  */
-#define EXTERNAL_INT1_TRIGGER    (1 << ISC11)
+#define EXTERNAL_INT1_TRIGGER    0
 
 /**
  * @brief setup for enabling the INT1 interrupt
@@ -101,6 +128,14 @@ typedef enum
 #define AVR_SLEEP_MODE           (1 << SM1)
 //#define AVR_SLEEP_MODE           SLEEP_MODE_PWR_DOWN
 
+/**
+ * @brief time to wait for a wake id after CAN activity in ms
+ *
+ * The frame waking the MCP2515 is lost, so this needs to be a bit longer
+ * than the cycle of the wake ids (CANID_1_WAKE, e.g. ignition 100ms).
+ */
+#define WAKE_CHECK_MS            150
+
 /***************************************************************************/
 /* STATES OF FSM                                                           */
 /***************************************************************************/
@@ -130,11 +165,28 @@ void sleepDetected(void);
  */
 void sleeping(void);
 
+/**
+ * @brief check whether CAN1 is to wake the gateway (selective wake up)
+ *
+ * The frame waking the MCP2515 is lost, so the ones following are awaited
+ * up to WAKE_CHECK_MS. While sleeping only the wake ids pass the filters
+ * (see can_filter_initWake()), so any frame received is one. Otherwise
+ * CAN1 is put to sleep again and the wake up is counted as spurious.
+ *
+ * @return true if the gateway is to wake up. Otherwise false is returned.
+ */
+bool checkWakeUp(void);
+
 /**
  * @brief wake up CAN and reinitialize the timers
  *
  * Now the AVR has woken up. Timers needs to be restarted, ADC to be enabled
  * again and the CAN controllers will also need to enter their working mode.
+ * CAN1 is awake since checkWakeUp() and gets its filters back, CAN2 is
+ * polled until it is in normal mode, instead of waiting a fixed time.
+ * Then all CAN2 messages are sent at once from the values
+ * stored before sleep (see comm_tx_burst()), the time from INT0 until then
+ * is kept in wakeStats.
  */
 void wakeUp(void);
 
@@ -167,15 +219,24 @@ void errorState(void);
  */
 void initHardware(void);
 
+/**
+ * @brief Register all periodic jobs
+ *
+ * This is the one place for any periodic work (\ref scheduler.h).
+ */
+void initSchedule(void);
+
 /**
  * @brief Initialize the CAN controllers
  *
  * Calls can_init_mcp2515 for each attached CAN controller and setting up
- * bit rate. If an error occurs some status LEDs will indicate it.
+ * bit rate. If an error occurs some status LEDs will indicate it. A failing
+ * CAN2 controller is taken off the bus and initialized again later (see
+ * can_fault.h), so the gateway keeps working on the CAN1 side.
  *
  * See chapter \ref page_can_bus for further details.
  *
- * @return true if all is ok. Otherwise false is returned.
+ * @return true if CAN1 is ok. Otherwise false is returned.
  */
 bool initCAN(void);
 
@@ -183,14 +244,55 @@ bool initCAN(void);
 /* HELPER ROUTINES                                                         */
 /***************************************************************************/
 
+/**
+ * @brief initialize a CAN controller with its bit rate and filters
+ * @param chip - selected MCP2515
+ * @return true if all is ok. Otherwise false is returned.
+ */
+bool initCanChip(eChipSelect chip);
+
+/**
+ * @brief wait for a CAN controller woken up to be in normal mode
+ * @param chip - selected MCP2515
+ * @return true if the controller is ready. Otherwise false is returned.
+ *
+ * A controller not ready in time is taken off the bus and initialized
+ * again later (see can_fault.h).
+ */
+bool wakeCanChip(eChipSelect chip);
+
+/**
+ * @brief initialize a CAN controller again after bus off
+ * @param chip - selected MCP2515
+ *
+ * Reception, transmission and, for CAN2, the cycles of the sent messages
+ * start over. Called by checkCanStatus() within can_rx_lock().
+ */
+void recoverCan(eChipSelect chip);
+
+/**
+ * @brief sleep in idle mode until the next interrupt, if there is no work
+ *
+ * Only sleeps, if no frame is received or to be sent, no scheduler tick is
+ * pending and the next CAN2 message is due after IDLE_MAX_TIME. Sends due
+ * earlier are polled for by the main loop.
+ */
+void enterIdle(void);
+
 /**
  * @brief handles CAN1 reception
+ *
+ * Processes all frames queued by the INT0 interrupt (\ref can_rx.h).
+ *
  * @param msg - pointer to message struct
  */
 void handleCan1Reception(can_t* msg);
 
 /**
  * @brief handles CAN2 reception
+ *
+ * Processes all frames queued by the INT1 interrupt (\ref can_rx.h).
+ *
  * @param msg - pointer to message struct
  */
 void handleCan2Reception(can_t* msg);
@@ -204,16 +306,37 @@ void handleCan1Transmission(can_t* msg);
 /**
  * @brief handle CAN2 transmission
  * @param msg - pointer to message struct
+ *
+ * Runs the periodic jobs (see initSchedule()) and sends the CAN2 messages
+ * due by cycle or changed content (see comm_tx_run()).
  */
 void handleCan2Transmission(can_t* msg);
 
 /**
- * @brief sends message to CAN2 and filling up converted data
+ * @brief check error flags and receive overflows of both CAN chips
+ *
+ * One EFLG read per chip. The flags are latched by the MCP2515, so a
+ * periodic check loses no overflow and keeps the main loop pass free of
+ * SPI transfers, if there is nothing to receive or send. Error passive and
+ * bus off change the transmission (see can_fault.h), a chip bus off for
+ * CAN_FAULT_RECOVERY_MS is initialized again.
+ */
+void checkCanStatus(void);
+
+/**
+ * @brief set dim value oversampled and start the next burst
  *
- * Note: Set message id before calling this function.
+ * Takes the value decimated by the ADC interrupt since the last call, if
+ * any. Nobody waits for a conversion.
+ */
+void sampleDimValue(void);
+
+/**
+ * @brief detect sleep of the master CAN bus
  *
- * @param msg - pointer to CAN message
+ * The quiet time until sleep depends on the ignition state (see
+ * comm_sleep.h). Replaces the fixed ~15s of Timer1.
  */
-void sendCan2Message(can_t* msg);
+void checkBusSleep(void);
 
 #endif /* CAN2MATRIX_H_ */
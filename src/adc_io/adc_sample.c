@@ -0,0 +1,132 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file adc_sample.c
+ *
+ * \date Created: 16.10.2026 21:24:21
+ * \author agent
+ **/
+
+
+#include <avr/io.h>
+#include <stdbool.h>
+
+#include "../modules/config/adc_config.h"
+
+#include "adc_sample.h"
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+//! bits of ADCSRA running a burst
+#define ADC_SAMPLE_BURST      ((1 << ADIE) | (1 << ADFR))
+
+//! compilation fails, if the sum of all samples exceeds 16 bit
+typedef char adc_sampleSumFits[(ADC_SAMPLE_EXTRA_BITS >= 1) &&
+                               (ADC_SAMPLE_EXTRA_BITS <= 3) ? 1 : -1];
+
+/***************************************************************************/
+/* VARIABLES                                                               */
+/***************************************************************************/
+
+//! sum of the samples of the running burst
+volatile uint16_t adc_sampleSum   = 0;
+
+//! samples of the running burst
+volatile uint8_t  adc_sampleCount = 0;
+
+//! decimated value of the last burst
+volatile uint16_t adc_sampleValue = 0;
+
+//! value of the last burst not taken yet
+volatile bool     adc_sampleReady = false;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief set up the ADC for oversampling
+ *
+ * Call after adc_init(). The value is right aligned, so the sum of all
+ * samples fits into 16 bit.
+ */
+void adc_sample_init(void)
+{
+   ADMUX = ADC_REF_SELECT | ADC_INPUT_CHANNEL;
+}
+
+/**
+ * \brief start a burst of conversions
+ *
+ * Does nothing, if a burst is running. Needs the ADC to be enabled.
+ */
+void adc_sample_start(void)
+{
+   if(ADCSRA & (1 << ADIE))
+   {
+      return;
+   }
+
+   adc_sampleSum   = 0;
+   adc_sampleCount = 0;
+   // drop a conversion completed after the last burst (ADIF is cleared by 1)
+   ADCSRA |= (1 << ADIF) | ADC_SAMPLE_BURST | (1 << ADSC);
+}
+
+/**
+ * \brief stop conversions and drop any value not taken, e.g. before sleep
+ */
+void adc_sample_stop(void)
+{
+   ADCSRA &= ~ADC_SAMPLE_BURST;
+   adc_sampleReady = false;
+}
+
+/**
+ * \brief take the decimated value of the last burst
+ * \param value - value left aligned to 16 bit, as returned by adc_get()
+ * \return true, if a value was ready
+ */
+bool adc_sample_get(uint16_t* value)
+{
+   if(false == adc_sampleReady)
+   {
+      return false;
+   }
+
+   // no burst running, so the interrupt does not change the value
+   *value          = adc_sampleValue << (16 - 10 - ADC_SAMPLE_EXTRA_BITS);
+   adc_sampleReady = false;
+
+   return true;
+}
+
+/**
+ * \brief add a conversion to the burst
+ *
+ * To be called by the ADC complete interrupt.
+ */
+void adc_sample_complete(void)
+{
+   adc_sampleSum += ADCW;
+
+   if(ADC_SAMPLE_COUNT == ++adc_sampleCount)
+   {
+      // the conversion running already completes without interrupt
+      ADCSRA &= ~ADC_SAMPLE_BURST;
+      adc_sampleValue = adc_sampleSum >> ADC_SAMPLE_EXTRA_BITS;
+      adc_sampleReady = true;
+   }
+}
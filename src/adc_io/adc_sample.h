@@ -0,0 +1,99 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file adc_sample.h
+ *
+ * Oversampling of the light sensor by interrupt. adc_sample_start() runs
+ * ADC_SAMPLE_COUNT conversions in free running mode, the ADC complete
+ * interrupt sums them up and decimates the sum to 10 +
+ * ADC_SAMPLE_EXTRA_BITS bit. Nobody waits for a conversion, the value is
+ * taken by adc_sample_get() when ready.
+ *
+ * A burst takes ADC_SAMPLE_COUNT * 13 ADC clocks, about 7ms at 4MHz and
+ * prescaler 128. The ADC noise reduction mode is not used, since it stops
+ * the timers of the scheduler tick and the timebase.
+ *
+ * \date Created: 16.10.2026 21:24:21
+ * \author agent
+ **/
+
+
+#ifndef ADC_SAMPLE_H_
+#define ADC_SAMPLE_H_
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \addtogroup adc_sample_definitions ADC Oversampling
+ * \brief definitions for oversampling and decimating the ADC value
+ * @{
+ */
+
+/**
+ * \def ADC_SAMPLE_EXTRA_BITS
+ * \brief bits of resolution gained by oversampling (1..3)
+ *
+ * Each extra bit takes four times the samples. The sensor noise needs to
+ * be at least one LSB for this to work, which an LDR easily provides.
+ */
+#define ADC_SAMPLE_EXTRA_BITS       2
+
+/**
+ * \def ADC_SAMPLE_COUNT
+ * \brief conversions per decimated value
+ */
+#define ADC_SAMPLE_COUNT            (1 << (2 * ADC_SAMPLE_EXTRA_BITS))
+
+/*! @} */
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief set up the ADC for oversampling
+ *
+ * Call after adc_init(). The value is right aligned, so the sum of all
+ * samples fits into 16 bit.
+ */
+void adc_sample_init(void);
+
+/**
+ * \brief start a burst of conversions
+ *
+ * Does nothing, if a burst is running. Needs the ADC to be enabled.
+ */
+void adc_sample_start(void);
+
+/**
+ * \brief stop conversions and drop any value not taken, e.g. before sleep
+ */
+void adc_sample_stop(void);
+
+/**
+ * \brief take the decimated value of the last burst
+ * \param value - value left aligned to 16 bit, as returned by adc_get()
+ * \return true, if a value was ready
+ */
+bool adc_sample_get(uint16_t* value);
+
+/**
+ * \brief add a conversion to the burst
+ *
+ * To be called by the ADC complete interrupt.
+ */
+void adc_sample_complete(void);
+
+#endif /* ADC_SAMPLE_H_ */
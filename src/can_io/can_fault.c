@@ -0,0 +1,181 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file can_fault.c
+ *
+ * \date Created: 16.10.2026 21:08:58
+ * \author agent
+ **/
+
+
+#include "../modules/can/can_mcp2515.h"
+
+#include "../sched/scheduler.h"
+#include "mcp2515_spi.h"
+#include "can_tx.h"
+#include "can_fault.h"
+
+/***************************************************************************/
+/* VARIABLES                                                               */
+/***************************************************************************/
+
+//! fault statistics for each chip
+can_fault_stats_t can_fault_stats[NUM_OF_MCP2515];
+
+//! time of bus off for each chip
+uint16_t can_fault_busOffSince[NUM_OF_MCP2515];
+
+//! time of last initialization attempt for each chip
+uint16_t can_fault_lastAttempt[NUM_OF_MCP2515];
+
+/***************************************************************************/
+/* HELPERS                                                                 */
+/***************************************************************************/
+
+/**
+ * \brief increment a statistics counter without wrapping around
+ * \param counter - pointer to counter
+ */
+void can_fault_increment(uint16_t* counter)
+{
+   if(UINT16_MAX != *counter)
+   {
+      ++(*counter);
+   }
+}
+
+/**
+ * \brief take a chip off the bus
+ * \param chip - selected MCP2515
+ */
+void can_fault_busOff(eChipSelect chip)
+{
+   can_fault_stats_t* stats = &can_fault_stats[chip];
+
+   stats->state                = CAN_FAULT_BUS_OFF;
+   can_fault_busOffSince[chip] = sched_getTime();
+   can_fault_lastAttempt[chip] = can_fault_busOffSince[chip];
+   can_fault_increment(&stats->busOff);
+
+   can_tx_suspend(chip);
+}
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief check the error flags of a chip
+ * \param chip - selected MCP2515
+ * \param eflg - EFLG as read, e.g. by can_rx_checkOverflow()
+ * \return true, if the chip is bus off long enough to be initialized again
+ *
+ * TEC and REC are read only, if EFLG shows the warning limit reached.
+ * Needs to be called within can_rx_lock()/can_rx_unlock(). After
+ * initializing the chip call can_fault_recovered().
+ */
+bool can_fault_check(eChipSelect chip, uint8_t eflg)
+{
+   can_fault_stats_t* stats = &can_fault_stats[chip];
+
+   if(CAN_FAULT_BUS_OFF == stats->state)
+   {
+      return ((uint16_t)(sched_getTime() - can_fault_lastAttempt[chip]) >=
+              SCHED_MS2TIME(CAN_FAULT_RECOVERY_MS));
+   }
+
+   if(eflg & (1 << MCP_EWARN))
+   {
+      stats->tec = mcp2515_spi_readRegister(chip, MCP_REG_TEC);
+      stats->rec = mcp2515_spi_readRegister(chip, MCP_REG_REC);
+   }
+   else
+   {
+      stats->tec = 0;
+      stats->rec = 0;
+   }
+
+   if(eflg & (1 << MCP_TXBO))
+   {
+      can_fault_busOff(chip);
+   }
+   else if(eflg & ((1 << MCP_TXEP) | (1 << MCP_RXEP)))
+   {
+      if(CAN_FAULT_ACTIVE == stats->state)
+      {
+         stats->state = CAN_FAULT_PASSIVE;
+         can_fault_increment(&stats->passive);
+         can_tx_setOneShot(chip, true);
+      }
+   }
+   else if(CAN_FAULT_PASSIVE == stats->state)
+   {
+      stats->state = CAN_FAULT_ACTIVE;
+      can_tx_setOneShot(chip, false);
+   }
+
+   return false;
+}
+
+/**
+ * \brief take a chip off the bus, since its initialization failed
+ * \param chip - selected MCP2515
+ */
+void can_fault_failed(eChipSelect chip)
+{
+   can_fault_busOff(chip);
+}
+
+/**
+ * \brief report the initialization of a chip after bus off
+ * \param chip - selected MCP2515
+ * \param success - true, if the chip is initialized
+ *
+ * On success transmission is resumed, otherwise it is tried again after
+ * CAN_FAULT_RECOVERY_MS.
+ */
+void can_fault_recovered(eChipSelect chip, bool success)
+{
+   can_fault_stats_t* stats = &can_fault_stats[chip];
+   uint16_t           now   = sched_getTime();
+   uint16_t           time  = now - can_fault_busOffSince[chip];
+
+   if(false == success)
+   {
+      can_fault_lastAttempt[chip] = now;
+      return;
+   }
+
+   stats->state        = CAN_FAULT_ACTIVE;
+   stats->tec          = 0;
+   stats->rec          = 0;
+   stats->lastRecovery = time;
+   if(time > stats->maxRecovery)
+   {
+      stats->maxRecovery = time;
+   }
+   can_fault_increment(&stats->recoveries);
+
+   can_tx_setOneShot(chip, false);
+   can_tx_resume(chip);
+}
+
+/**
+ * \brief get fault statistics of a chip
+ * \param chip - selected MCP2515
+ * \return pointer to statistics
+ */
+can_fault_stats_t* can_fault_getStats(eChipSelect chip)
+{
+   return &can_fault_stats[chip];
+}
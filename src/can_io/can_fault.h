@@ -0,0 +1,137 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file can_fault.h
+ *
+ * Fault confinement of the CAN chips. The error flags (EFLG) read
+ * periodically decide how transmission goes on:
+ *
+ * * error active - frames are sent as configured (see can_tx.h)
+ * * error passive - one shot mode, e.g. the radio is missing and no frame
+ *   gets acknowledged; every frame is tried once instead of retrying it
+ *   until its lifetime ends
+ * * bus off - transmission is suspended and every frame to send is dropped
+ *   at once; after CAN_FAULT_RECOVERY_MS the chip is initialized again
+ *
+ * A chip failing its initialization is bus off as well, so it is retried
+ * instead of stopping the gateway.
+ *
+ * \date Created: 16.10.2026 21:08:58
+ * \author agent
+ **/
+
+
+#ifndef CAN_FAULT_H_
+#define CAN_FAULT_H_
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \addtogroup can_fault_definitions CAN Fault Confinement
+ * \brief definitions for error passive and bus off handling
+ * @{
+ */
+
+/**
+ * \def CAN_FAULT_RECOVERY_MS
+ * \brief time between bus off and the next initialization of a chip in ms
+ */
+#define CAN_FAULT_RECOVERY_MS       1000
+
+/*! @} */
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief fault confinement state of a chip
+ */
+typedef enum
+{
+   //! error active, normal transmission
+   CAN_FAULT_ACTIVE  = 0,
+   //! error passive, one shot mode
+   CAN_FAULT_PASSIVE = 1,
+   //! bus off or not initialized, transmission suspended
+   CAN_FAULT_BUS_OFF = 2
+} can_fault_state_t;
+
+/**
+ * \brief fault statistics of one chip
+ *
+ * Counters saturate instead of wrapping around. Times are in units of
+ * sched_getTime().
+ */
+typedef struct
+{
+   //! changes to error passive
+   uint16_t passive;
+   //! changes to bus off, including failed initializations
+   uint16_t busOff;
+   //! initializations after bus off
+   uint16_t recoveries;
+   //! time from bus off to the last successful initialization
+   uint16_t lastRecovery;
+   //! worst time from bus off to a successful initialization
+   uint16_t maxRecovery;
+   //! transmit error counter (0 below the warning limit)
+   uint8_t  tec;
+   //! receive error counter (0 below the warning limit)
+   uint8_t  rec;
+   //! current state (can_fault_state_t)
+   uint8_t  state;
+} can_fault_stats_t;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief check the error flags of a chip
+ * \param chip - selected MCP2515
+ * \param eflg - EFLG as read, e.g. by can_rx_checkOverflow()
+ * \return true, if the chip is bus off long enough to be initialized again
+ *
+ * TEC and REC are read only, if EFLG shows the warning limit reached.
+ * Needs to be called within can_rx_lock()/can_rx_unlock(). After
+ * initializing the chip call can_fault_recovered().
+ */
+bool can_fault_check(eChipSelect chip, uint8_t eflg);
+
+/**
+ * \brief take a chip off the bus, since its initialization failed
+ * \param chip - selected MCP2515
+ */
+void can_fault_failed(eChipSelect chip);
+
+/**
+ * \brief report the initialization of a chip after bus off
+ * \param chip - selected MCP2515
+ * \param success - true, if the chip is initialized
+ *
+ * On success transmission is resumed, otherwise it is tried again after
+ * CAN_FAULT_RECOVERY_MS.
+ */
+void can_fault_recovered(eChipSelect chip, bool success);
+
+/**
+ * \brief get fault statistics of a chip
+ * \param chip - selected MCP2515
+ * \return pointer to statistics
+ */
+can_fault_stats_t* can_fault_getStats(eChipSelect chip);
+
+#endif /* CAN_FAULT_H_ */
@@ -0,0 +1,177 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file can_filter.c
+ *
+ * \date Created: 16.10.2026 20:40:10
+ * \author agent
+ **/
+
+
+#include <avr/pgmspace.h>
+#include <stdbool.h>
+
+#include "../modules/can/can_mcp2515.h"
+#include "../modules/spi/spi.h"
+
+#include "mcp2515_spi.h"
+#include "can_filter_config.h"
+#include "can_filter.h"
+
+/***************************************************************************/
+/* VARIABLES                                                               */
+/***************************************************************************/
+
+//! acceptance masks RXM0, RXM1 of each chip
+const uint16_t can_filter_masks[NUM_OF_MCP2515][MCP_NUM_MASKS] PROGMEM =
+{
+   { CAN_FILTER_CHIP1_MASKS },
+   { CAN_FILTER_CHIP2_MASKS }
+};
+
+//! acceptance filters RXF0..RXF5 of each chip
+const uint16_t can_filter_filters[NUM_OF_MCP2515][MCP_NUM_FILTERS] PROGMEM =
+{
+   { CAN_FILTER_CHIP1_FILTERS },
+   { CAN_FILTER_CHIP2_FILTERS }
+};
+
+//! acceptance masks RXM0, RXM1 of each chip while sleeping
+const uint16_t can_filter_wakeMasks[NUM_OF_MCP2515][MCP_NUM_MASKS] PROGMEM =
+{
+   { CAN_FILTER_CHIP1_WAKE_MASKS },
+   { CAN_FILTER_CHIP2_WAKE_MASKS }
+};
+
+//! acceptance filters RXF0..RXF5 of each chip while sleeping
+const uint16_t can_filter_wakeFilters[NUM_OF_MCP2515][MCP_NUM_FILTERS] PROGMEM =
+{
+   { CAN_FILTER_CHIP1_WAKE_FILTERS },
+   { CAN_FILTER_CHIP2_WAKE_FILTERS }
+};
+
+//! number of unwanted ids passing the filters of each chip
+const uint16_t can_filter_unwanted[NUM_OF_MCP2515] PROGMEM =
+{
+   CAN_FILTER_CHIP1_UNWANTED,
+   CAN_FILTER_CHIP2_UNWANTED
+};
+
+/***************************************************************************/
+/* HELPERS                                                                 */
+/***************************************************************************/
+
+/**
+ * \brief write a standard id to a mask or filter
+ * \param chip - selected MCP2515
+ * \param address - address of SIDH register
+ * \param id - standard id (11bit)
+ *
+ * SIDH, SIDL, EID8 and EID0 are written in one sequence. EXIDE stays
+ * cleared, so only standard frames match.
+ */
+void can_filter_writeId(eChipSelect chip, uint8_t address, uint16_t id)
+{
+   mcp2515_spi_select(chip);
+   mcp2515_spi_putc(MCP_INSTR_WRITE);
+   mcp2515_spi_putc(address);
+   mcp2515_spi_putc((uint8_t)(id >> 3));
+   mcp2515_spi_putc((uint8_t)(id << 5));
+   mcp2515_spi_putc(0);
+   mcp2515_spi_putc(0);
+   mcp2515_spi_unselect(chip);
+}
+
+/**
+ * \brief write acceptance masks and filters of a chip
+ * \param chip - selected MCP2515
+ * \param masks - RXM0, RXM1 (flash)
+ * \param filters - RXF0..RXF5 (flash)
+ * \return true, if filters are set and chip is back in its former mode
+ *
+ * Only standard frames are accepted by both receive buffers.
+ */
+bool can_filter_load(eChipSelect     chip,
+                     const uint16_t* masks,
+                     const uint16_t* filters)
+{
+   uint8_t mode = mcp2515_spi_readRegister(chip, MCP_REG_CANSTAT) &
+                  MCP_OPMOD_MASK;
+   uint8_t i;
+
+   // masks and filters are writable in configuration mode only
+   if(false == mcp2515_spi_setMode(chip, MCP_OPMOD_CONFIG))
+   {
+      return false;
+   }
+
+   for(i = 0; i < MCP_NUM_MASKS; ++i)
+   {
+      can_filter_writeId(chip, MCP_REG_RXMSIDH(i), pgm_read_word(&masks[i]));
+   }
+
+   for(i = 0; i < MCP_NUM_FILTERS; ++i)
+   {
+      can_filter_writeId(chip, MCP_REG_RXFSIDH(i), pgm_read_word(&filters[i]));
+   }
+
+   // both receive buffers use masks and filters
+   mcp2515_spi_writeBits(chip, MCP_REG_RXB0CTRL, MCP_RXM_MASK, 0);
+   mcp2515_spi_writeBits(chip, MCP_REG_RXB1CTRL, MCP_RXM_MASK, 0);
+
+   return mcp2515_spi_setMode(chip, mode);
+}
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief set acceptance masks and filters of a chip
+ * \param chip - selected MCP2515
+ * \return true, if filters are set and chip is back in its former mode
+ *
+ * Only standard frames are accepted by both receive buffers. The settings
+ * survive sleep mode. Call before can_rx_enable() or within
+ * can_rx_lock()/can_rx_unlock().
+ */
+bool can_filter_init(eChipSelect chip)
+{
+   return can_filter_load(chip, can_filter_masks[chip],
+                          can_filter_filters[chip]);
+}
+
+/**
+ * \brief set acceptance masks and filters of a chip for sleeping
+ * \param chip - selected MCP2515
+ * \return true, if filters are set and chip is back in its former mode
+ *
+ * Only the ids waking the gateway pass (CANID_x_WAKE of comm_matrix_gen.h),
+ * any id, if there are none. Call after can_rx_disable() and before
+ * putting the chip to sleep, can_filter_init() restores the filters.
+ */
+bool can_filter_initWake(eChipSelect chip)
+{
+   return can_filter_load(chip, can_filter_wakeMasks[chip],
+                          can_filter_wakeFilters[chip]);
+}
+
+/**
+ * \brief get number of unwanted ids passing the filters of a chip
+ * \param chip - selected MCP2515
+ * \return number of standard ids accepted, but not consumed
+ */
+uint16_t can_filter_getUnwanted(eChipSelect chip)
+{
+   return pgm_read_word(&can_filter_unwanted[chip]);
+}
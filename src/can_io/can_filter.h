@@ -0,0 +1,62 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file can_filter.h
+ *
+ * MCP2515 acceptance filtering. Masks and filters are generated from the
+ * CAN ids consumed (see CANID_1_CONSUMED and CANID_2_CONSUMED), so frames
+ * not used by the matrix never reach a receive buffer and cost neither an
+ * interrupt nor a SPI read.
+ *
+ * \date Created: 16.10.2026 20:40:10
+ * \author agent
+ **/
+
+
+#ifndef CAN_FILTER_H_
+#define CAN_FILTER_H_
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief set acceptance masks and filters of a chip
+ * \param chip - selected MCP2515
+ * \return true, if filters are set and chip is back in its former mode
+ *
+ * Only standard frames are accepted by both receive buffers. The settings
+ * survive sleep mode. Call before can_rx_enable() or within
+ * can_rx_lock()/can_rx_unlock().
+ */
+bool can_filter_init(eChipSelect chip);
+
+/**
+ * \brief set acceptance masks and filters of a chip for sleeping
+ * \param chip - selected MCP2515
+ * \return true, if filters are set and chip is back in its former mode
+ *
+ * Only the ids waking the gateway pass (CANID_x_WAKE of comm_matrix_gen.h),
+ * any id, if there are none. Call after can_rx_disable() and before
+ * putting the chip to sleep, can_filter_init() restores the filters.
+ */
+bool can_filter_initWake(eChipSelect chip);
+
+/**
+ * \brief get number of unwanted ids passing the filters of a chip
+ * \param chip - selected MCP2515
+ * \return number of standard ids accepted, but not consumed
+ */
+uint16_t can_filter_getUnwanted(eChipSelect chip);
+
+#endif /* CAN_FILTER_H_ */
@@ -0,0 +1,79 @@
+/**
+ * \file can_filter_config.h
+ *
+ * Generated by tools/matrix_compiler from comm_matrix.mtx - do not edit!
+ *
+ * Masks and filters cover all consumed ids with the least number
+ * of other ids passing.
+ **/
+
+#ifndef CAN_FILTER_CONFIG_H_
+#define CAN_FILTER_CONFIG_H_
+
+/**
+ * \def CAN_FILTER_CHIP1_MASKS
+ * \brief RXM0, RXM1 of CAN #1
+ *
+ * \def CAN_FILTER_CHIP1_FILTERS
+ * \brief RXF0..RXF5 of CAN #1
+ *
+ * \def CAN_FILTER_CHIP1_UNWANTED
+ * \brief number of ids accepted, but not consumed on CAN #1
+ *
+ * Consumed:
+ * - CANID_1_IGNITION
+ * - CANID_1_COM_DISP_START
+ * - CANID_1_WHEEL_GEAR_DATA
+ * - CANID_1_RPM_STATUS
+ * - CANID_1_PDC_STATUS
+ * - CANID_1_TIME_AND_ODO
+ * - CANID_1_COM_CLUSTER_2_RADIO
+ */
+#define CAN_FILTER_CHIP1_MASKS      0x7FD, 0x7FF
+#define CAN_FILTER_CHIP1_FILTERS    0x271, 0x351, 0x2E8, 0x54B, 0x65D, 0x699
+#define CAN_FILTER_CHIP1_UNWANTED   1
+
+/**
+ * \def CAN_FILTER_CHIP1_WAKE_MASKS
+ * \brief RXM0, RXM1 of CAN #1 while sleeping
+ *
+ * \def CAN_FILTER_CHIP1_WAKE_FILTERS
+ * \brief RXF0..RXF5 of CAN #1 while sleeping
+ *
+ * Waking:
+ * - CANID_1_IGNITION
+ */
+#define CAN_FILTER_CHIP1_WAKE_MASKS   0x7FF, 0x7FF
+#define CAN_FILTER_CHIP1_WAKE_FILTERS 0x271, 0x271, 0x271, 0x271, 0x271, 0x271
+
+/**
+ * \def CAN_FILTER_CHIP2_MASKS
+ * \brief RXM0, RXM1 of CAN #2
+ *
+ * \def CAN_FILTER_CHIP2_FILTERS
+ * \brief RXF0..RXF5 of CAN #2
+ *
+ * \def CAN_FILTER_CHIP2_UNWANTED
+ * \brief number of ids accepted, but not consumed on CAN #2
+ *
+ * Consumed:
+ * - none
+ */
+#define CAN_FILTER_CHIP2_MASKS      0x7FF, 0x7FF
+#define CAN_FILTER_CHIP2_FILTERS    0x000, 0x000, 0x000, 0x000, 0x000, 0x000
+#define CAN_FILTER_CHIP2_UNWANTED   1
+
+/**
+ * \def CAN_FILTER_CHIP2_WAKE_MASKS
+ * \brief RXM0, RXM1 of CAN #2 while sleeping
+ *
+ * \def CAN_FILTER_CHIP2_WAKE_FILTERS
+ * \brief RXF0..RXF5 of CAN #2 while sleeping
+ *
+ * Waking:
+ * - any id
+ */
+#define CAN_FILTER_CHIP2_WAKE_MASKS   0x000, 0x000
+#define CAN_FILTER_CHIP2_WAKE_FILTERS 0x000, 0x000, 0x000, 0x000, 0x000, 0x000
+
+#endif /* CAN_FILTER_CONFIG_H_ */
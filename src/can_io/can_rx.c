@@ -0,0 +1,341 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file can_rx.c
+ *
+ * \date Created: 16.10.2026 20:32:43
+ * \author agent
+ **/
+
+
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#include "../modules/can/can_mcp2515.h"
+
+#include "mcp2515_spi.h"
+#include "can_rx.h"
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief receive queue of one chip
+ *
+ * head is written by the ISR only, tail by the main loop only. Both are
+ * free running, so head - tail is the fill level.
+ */
+typedef struct
+{
+   //! storage of queued frames
+   can_t*           buffer;
+   //! index mask (size - 1)
+   uint8_t          mask;
+   //! next frame to write (ISR)
+   volatile uint8_t head;
+   //! next frame to read (main loop)
+   volatile uint8_t tail;
+} can_rx_queue_t;
+
+/***************************************************************************/
+/* VARIABLES                                                               */
+/***************************************************************************/
+
+//! frame storage CAN1
+can_t can_rx_bufferChip1[CAN_RX_QUEUE_SIZE_CHIP1];
+
+//! frame storage CAN2
+can_t can_rx_bufferChip2[CAN_RX_QUEUE_SIZE_CHIP2];
+
+//! receive queues for each chip
+can_rx_queue_t can_rx_queues[NUM_OF_MCP2515] =
+{
+   { can_rx_bufferChip1, CAN_RX_QUEUE_SIZE_CHIP1 - 1, 0, 0 },
+   { can_rx_bufferChip2, CAN_RX_QUEUE_SIZE_CHIP2 - 1, 0, 0 }
+};
+
+//! external interrupt enable bit of each chip
+uint8_t can_rx_intEnable[NUM_OF_MCP2515] = { CAN_RX_INT_ENABLES };
+
+//! interrupts enabled for reception
+volatile uint8_t can_rx_enabled = 0;
+
+//! interrupts parked by the ISR (queue full)
+volatile uint8_t can_rx_parked  = 0;
+
+//! nesting of locks, main loop or SPI transaction using SPI
+volatile uint8_t can_rx_locked  = 0;
+
+//! reception statistics for each chip
+can_rx_stats_t can_rx_stats[NUM_OF_MCP2515];
+
+/***************************************************************************/
+/* HELPERS                                                                 */
+/***************************************************************************/
+
+/**
+ * \brief set external interrupt enables according to current state
+ *
+ * Must be called with interrupts disabled.
+ */
+void can_rx_updateGICR(void)
+{
+   uint8_t all = can_rx_intEnable[CAN_CHIP1] | can_rx_intEnable[CAN_CHIP2];
+
+   GICR &= ~all;
+   if(0 == can_rx_locked)
+   {
+      GICR |= (can_rx_enabled & ~can_rx_parked);
+   }
+}
+
+/**
+ * \brief increment a statistics counter without wrapping around
+ * \param counter - pointer to counter
+ */
+void can_rx_increment(uint16_t* counter)
+{
+   if(UINT16_MAX != *counter)
+   {
+      ++(*counter);
+   }
+}
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief enable interrupt driven reception of a chip
+ * \param chip - selected MCP2515
+ *
+ * Sets the MCP2515 to signal received frames only on its INT pin, enables
+ * roll over from RXB0 to RXB1 and the external interrupt of the AVR. Call with interrupts
+ * disabled or before any CAN interrupt may occur.
+ */
+void can_rx_enable(eChipSelect chip)
+{
+   can_rx_queue_t* queue = &can_rx_queues[chip];
+
+   queue->head = 0;
+   queue->tail = 0;
+
+   // only received frames are signalled by INT pin
+   mcp2515_spi_writeBits(chip, MCP_REG_CANINTE, 0xFF,
+                         (1 << MCP_RX0IE) | (1 << MCP_RX1IE));
+   // a full RXB0 rolls over to RXB1 instead of dropping the frame
+   mcp2515_spi_writeBits(chip, MCP_REG_RXB0CTRL,
+                         (1 << MCP_BUKT), (1 << MCP_BUKT));
+
+   can_rx_enabled |= can_rx_intEnable[chip];
+   can_rx_parked  &= ~can_rx_intEnable[chip];
+   can_rx_updateGICR();
+}
+
+/**
+ * \brief disable interrupt driven reception of a chip
+ * \param chip - selected MCP2515
+ *
+ * Queued frames are discarded. The register shadow is forgotten, since the
+ * chip is handed over to the CAN module, e.g. for sleep.
+ */
+void can_rx_disable(eChipSelect chip)
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      can_rx_enabled &= ~can_rx_intEnable[chip];
+      can_rx_updateGICR();
+      can_rx_queues[chip].tail = can_rx_queues[chip].head;
+   }
+   mcp2515_spi_forget(chip);
+}
+
+/**
+ * \brief fetch all frames of a chip into its queue
+ * \param chip - selected MCP2515
+ *
+ * To be called by the external interrupt of the chip only. If the queue
+ * is full, the interrupt is parked and the frames stay in the MCP2515
+ * until the main loop has made room.
+ */
+void can_rx_fetch(eChipSelect chip)
+{
+   can_rx_queue_t* queue = &can_rx_queues[chip];
+   uint8_t status = mcp2515_spi_rxStatus(chip) & MCP_RX_STATUS_MSG_MASK;
+
+   if(0 == status)
+   {
+      // INT pin is low without a frame - park it until next main loop pass
+      can_rx_parked |= can_rx_intEnable[chip];
+   }
+
+   while(0 != status)
+   {
+      if((uint8_t)(queue->head - queue->tail) > queue->mask)
+      {
+         // no room left, keep frames in the MCP2515 for now
+         can_rx_parked |= can_rx_intEnable[chip];
+         can_rx_increment(&can_rx_stats[chip].queueFull);
+         break;
+      }
+
+      mcp2515_spi_readRxBuffer(chip,
+                               (status & MCP_RX_STATUS_RXB0) ? 0 : 1,
+                               &queue->buffer[queue->head & queue->mask]);
+      ++queue->head;
+      can_rx_increment(&can_rx_stats[chip].frames);
+
+      status = mcp2515_spi_rxStatus(chip) & MCP_RX_STATUS_MSG_MASK;
+   }
+
+   can_rx_updateGICR();
+}
+
+/**
+ * \brief get next queued frame of a chip
+ * \param chip - selected MCP2515
+ * \param msg - pointer to CAN message to fill
+ * \return true, if a frame was copied
+ */
+bool can_rx_get(eChipSelect chip, can_t* msg)
+{
+   can_rx_queue_t* queue = &can_rx_queues[chip];
+   bool retVal = false;
+
+   if(queue->head != queue->tail)
+   {
+      *msg = queue->buffer[queue->tail & queue->mask];
+      ++queue->tail;
+      retVal = true;
+   }
+
+   // there is room in the queue (again), so re-arm a parked interrupt
+   if(can_rx_parked & can_rx_intEnable[chip])
+   {
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+      {
+         can_rx_parked &= ~can_rx_intEnable[chip];
+         can_rx_updateGICR();
+      }
+   }
+
+   return retVal;
+}
+
+/**
+ * \brief check for frames not processed yet
+ * \param chip - selected MCP2515
+ * \return true, if frames are queued or the interrupt is parked
+ *
+ * A parked interrupt is re-armed by the next can_rx_get() only.
+ */
+bool can_rx_isPending(eChipSelect chip)
+{
+   return (can_rx_queues[chip].head != can_rx_queues[chip].tail) ||
+          (0 != (can_rx_parked & can_rx_intEnable[chip]));
+}
+
+/**
+ * \brief count frames processed in one main loop pass
+ * \param chip - selected MCP2515
+ * \param frames - number of frames processed in this pass
+ */
+void can_rx_countPass(eChipSelect chip, uint8_t frames)
+{
+   can_rx_stats_t* stats = &can_rx_stats[chip];
+
+   stats->framesLastPass = frames;
+   if(frames > stats->framesMaxPass)
+   {
+      stats->framesMaxPass = frames;
+   }
+}
+
+/**
+ * \brief count a frame not used, but passing the acceptance filters
+ * \param chip - selected MCP2515
+ * \sa can_filter_getUnwanted()
+ */
+void can_rx_countUnwanted(eChipSelect chip)
+{
+   can_rx_increment(&can_rx_stats[chip].unwanted);
+}
+
+/**
+ * \brief check and clear receive buffer overflows of a chip
+ * \param chip - selected MCP2515
+ * \return EFLG as read, e.g. to check MCP_EFLG_ERRORS
+ *
+ * Reads EFLG and counts RX0OVR/RX1OVR events. The MCP2515 keeps the flags
+ * until cleared, so polling periodically loses no event. Needs to be called
+ * within can_rx_lock()/can_rx_unlock().
+ */
+uint8_t can_rx_checkOverflow(eChipSelect chip)
+{
+   uint8_t eflg     = mcp2515_spi_readRegister(chip, MCP_REG_EFLG);
+   uint8_t overflow = eflg & ((1 << MCP_RX0OVR) | (1 << MCP_RX1OVR));
+
+   if(0 != overflow)
+   {
+      if(overflow & (1 << MCP_RX0OVR))
+      {
+         can_rx_increment(&can_rx_stats[chip].rx0Overflows);
+      }
+      if(overflow & (1 << MCP_RX1OVR))
+      {
+         can_rx_increment(&can_rx_stats[chip].rx1Overflows);
+      }
+      // clear flags, otherwise the next overflow is not seen
+      mcp2515_spi_bitModify(chip, MCP_REG_EFLG, overflow, 0);
+   }
+
+   return eflg;
+}
+
+/**
+ * \brief get reception statistics of a chip
+ * \param chip - selected MCP2515
+ * \return pointer to statistics
+ */
+can_rx_stats_t* can_rx_getStats(eChipSelect chip)
+{
+   return &can_rx_stats[chip];
+}
+
+/**
+ * \brief lock reception interrupts while the main loop uses SPI
+ *
+ * Any SPI access to the MCP2515 outside of the reception ISR needs to be
+ * embraced by can_rx_lock() and can_rx_unlock().
+ */
+void can_rx_lock(void)
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      ++can_rx_locked;
+      can_rx_updateGICR();
+   }
+}
+
+/**
+ * \brief unlock reception interrupts after SPI usage of the main loop
+ */
+void can_rx_unlock(void)
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      --can_rx_locked;
+      can_rx_updateGICR();
+   }
+}
@@ -0,0 +1,188 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file can_rx.h
+ *
+ * Interrupt driven CAN reception. The INT pins of the MCP2515 (see
+ * CAN_INT_PORTS) trigger INT0/INT1 and the ISR pulls all received frames
+ * into a queue per chip. The main loop only processes what is queued.
+ *
+ * \date Created: 16.10.2026 20:32:43
+ * \author agent
+ **/
+
+
+#ifndef CAN_RX_H_
+#define CAN_RX_H_
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \addtogroup can_rx_definitions Interrupt Driven CAN Reception
+ * \brief definitions for the receive queues
+ * @{
+ */
+
+/**
+ * \def CAN_RX_QUEUE_SIZE_CHIP1
+ * \brief number of frames queued for CAN1 (master)
+ *
+ * \def CAN_RX_QUEUE_SIZE_CHIP2
+ * \brief number of frames queued for CAN2 (slave)
+ *
+ * Sizes must be a power of 2. The two receive buffers of each MCP2515
+ * (rollover enabled) hold frames on top, so a main loop pass may take as
+ * long as 6 frames on CAN1 before one is lost. CAN2 is hardly receiving
+ * anything right now. Losses are counted in can_rx_stats_t.
+ */
+#define CAN_RX_QUEUE_SIZE_CHIP1     4
+#define CAN_RX_QUEUE_SIZE_CHIP2     2
+
+/**
+ * \def CAN_RX_INT_ENABLES
+ * \brief external interrupt enable bits (GICR) for each can chip
+ *
+ * This structure has to correspond with CAN_INT_PORTS (PD2 - INT0,
+ * PD3 - INT1) and the chip select enumeration.
+ * \sa eChipSelect
+ */
+#define CAN_RX_INT_ENABLES          (1 << INT0), \
+                                    (1 << INT1)
+
+/*! @} */
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief reception statistics of one chip
+ *
+ * Counters saturate instead of wrapping around.
+ */
+typedef struct
+{
+   //! frames received
+   uint16_t frames;
+   //! RXB0 overflows signalled by RX0OVR
+   uint16_t rx0Overflows;
+   //! RXB1 overflows signalled by RX1OVR
+   uint16_t rx1Overflows;
+   //! ISR found the queue full and parked the interrupt
+   uint16_t queueFull;
+   //! frames passing the acceptance filters, but not used
+   uint16_t unwanted;
+   //! frames processed in the last main loop pass
+   uint8_t  framesLastPass;
+   //! maximum frames processed in one main loop pass
+   uint8_t  framesMaxPass;
+} can_rx_stats_t;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief enable interrupt driven reception of a chip
+ * \param chip - selected MCP2515
+ *
+ * Sets the MCP2515 to signal received frames only on its INT pin, enables
+ * roll over from RXB0 to RXB1 and the external interrupt of the AVR. Call with interrupts
+ * disabled or before any CAN interrupt may occur.
+ */
+void can_rx_enable(eChipSelect chip);
+
+/**
+ * \brief disable interrupt driven reception of a chip
+ * \param chip - selected MCP2515
+ *
+ * Queued frames are discarded. The register shadow is forgotten, since the
+ * chip is handed over to the CAN module, e.g. for sleep.
+ */
+void can_rx_disable(eChipSelect chip);
+
+/**
+ * \brief fetch all frames of a chip into its queue
+ * \param chip - selected MCP2515
+ *
+ * To be called by the external interrupt of the chip only. If the queue
+ * is full, the interrupt is parked and the frames stay in the MCP2515
+ * until the main loop has made room.
+ */
+void can_rx_fetch(eChipSelect chip);
+
+/**
+ * \brief get next queued frame of a chip
+ * \param chip - selected MCP2515
+ * \param msg - pointer to CAN message to fill
+ * \return true, if a frame was copied
+ */
+bool can_rx_get(eChipSelect chip, can_t* msg);
+
+/**
+ * \brief count frames processed in one main loop pass
+ * \param chip - selected MCP2515
+ * \param frames - number of frames processed in this pass
+ */
+void can_rx_countPass(eChipSelect chip, uint8_t frames);
+
+/**
+ * \brief check for frames not processed yet
+ * \param chip - selected MCP2515
+ * \return true, if frames are queued or the interrupt is parked
+ *
+ * A parked interrupt is re-armed by the next can_rx_get() only.
+ */
+bool can_rx_isPending(eChipSelect chip);
+
+/**
+ * \brief count a frame not used, but passing the acceptance filters
+ * \param chip - selected MCP2515
+ * \sa can_filter_getUnwanted()
+ */
+void can_rx_countUnwanted(eChipSelect chip);
+
+/**
+ * \brief check and clear receive buffer overflows of a chip
+ * \param chip - selected MCP2515
+ * \return EFLG as read, e.g. to check MCP_EFLG_ERRORS
+ *
+ * Reads EFLG and counts RX0OVR/RX1OVR events. The MCP2515 keeps the flags
+ * until cleared, so polling periodically loses no event. Needs to be called
+ * within can_rx_lock()/can_rx_unlock().
+ */
+uint8_t can_rx_checkOverflow(eChipSelect chip);
+
+/**
+ * \brief get reception statistics of a chip
+ * \param chip - selected MCP2515
+ * \return pointer to statistics
+ */
+can_rx_stats_t* can_rx_getStats(eChipSelect chip);
+
+/**
+ * \brief lock reception interrupts while the main loop uses SPI
+ *
+ * Any SPI access to the MCP2515 outside of the reception ISR needs to be
+ * embraced by can_rx_lock() and can_rx_unlock().
+ */
+void can_rx_lock(void);
+
+/**
+ * \brief unlock reception interrupts after SPI usage of the main loop
+ */
+void can_rx_unlock(void);
+
+#endif /* CAN_RX_H_ */
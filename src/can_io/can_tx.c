@@ -0,0 +1,614 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file can_tx.c
+ *
+ * \date Created: 16.10.2026 20:36:41
+ * \author agent
+ **/
+
+
+#include "../modules/can/can_mcp2515.h"
+
+#include "../sched/scheduler.h"
+#include "mcp2515_spi.h"
+#include "can_rx.h"
+#include "can_tx.h"
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief frame waiting for a transmit buffer
+ */
+typedef struct
+{
+   //! frame to send
+   can_t    msg;
+   //! time when queued
+   uint16_t queued;
+   //! time to send the frame
+   uint16_t lifetime;
+   //! TXP priority
+   uint8_t  prio;
+   //! cyclic or sequence frame
+   uint8_t  mode;
+} can_tx_entry_t;
+
+/**
+ * \brief shadow of the transmit buffers of a chip
+ */
+typedef struct
+{
+   //! frame held by transmit buffer (data valid up to its len)
+   can_t   frame[MCP_NUM_TX_BUFFERS];
+   //! TXP priority of transmit buffer
+   uint8_t prio[MCP_NUM_TX_BUFFERS];
+   //! transmit buffers with a valid shadow (bit mask)
+   uint8_t valid;
+} can_tx_shadow_t;
+
+/**
+ * \brief transmit queue and buffer state of one chip
+ *
+ * Entries are kept in the order they were queued. A replaced cyclic frame
+ * keeps its place, but gets a new queuing time.
+ */
+typedef struct
+{
+   //! storage of queued frames
+   can_tx_entry_t*  entry;
+   //! shadow of transmit buffers (0 - none)
+   can_tx_shadow_t* shadow;
+   //! number of entries
+   uint8_t          size;
+   //! number of queued frames
+   uint8_t          count;
+   //! transmit buffers loaded and not yet sent (bit mask)
+   uint8_t          inFlight;
+   //! transmit buffers loaded with a sequence frame (bit mask)
+   uint8_t          inFlightSeq;
+   //! time when buffer was loaded
+   uint16_t         loaded[MCP_NUM_TX_BUFFERS];
+   //! lifetime left when buffer was loaded
+   uint16_t         lifetime[MCP_NUM_TX_BUFFERS];
+   //! transmission suspended, e.g. bus off
+   bool             suspended;
+   //! one shot mode forced, e.g. error passive
+   bool             oneShot;
+#ifdef PROFILE_ENABLE
+   //! called for each frame loaded (0 - none)
+   can_tx_hook_t    hook;
+#endif
+} can_tx_queue_t;
+
+/**
+ * \def CAN_TX_NONE
+ * \brief no frame to load, see can_tx_next()
+ */
+#define CAN_TX_NONE                 0xFF
+
+/***************************************************************************/
+/* VARIABLES                                                               */
+/***************************************************************************/
+
+//! frame storage CAN1
+can_tx_entry_t can_tx_entriesChip1[CAN_TX_QUEUE_SIZE_CHIP1];
+
+//! frame storage CAN2
+can_tx_entry_t can_tx_entriesChip2[CAN_TX_QUEUE_SIZE_CHIP2];
+
+//! shadow of the transmit buffers of CAN_TX_SHADOW_CHIP
+can_tx_shadow_t can_tx_shadow;
+
+//! transmit queues for each chip
+can_tx_queue_t can_tx_queues[NUM_OF_MCP2515] =
+{
+   { can_tx_entriesChip1,
+     (CAN_CHIP1 == CAN_TX_SHADOW_CHIP) ? &can_tx_shadow : 0,
+     CAN_TX_QUEUE_SIZE_CHIP1 },
+   { can_tx_entriesChip2,
+     (CAN_CHIP2 == CAN_TX_SHADOW_CHIP) ? &can_tx_shadow : 0,
+     CAN_TX_QUEUE_SIZE_CHIP2 }
+};
+
+//! transmit statistics for each chip
+can_tx_stats_t can_tx_stats[NUM_OF_MCP2515];
+
+/***************************************************************************/
+/* HELPERS                                                                 */
+/***************************************************************************/
+
+/**
+ * \brief increment a statistics counter without wrapping around
+ * \param counter - pointer to counter
+ */
+void can_tx_increment(uint16_t* counter)
+{
+   if(UINT16_MAX != *counter)
+   {
+      ++(*counter);
+   }
+}
+
+/**
+ * \brief find next frame to load
+ * \param queue - pointer to queue of chip
+ * \param now - current time
+ * \return index of frame or CAN_TX_NONE, if none may be loaded
+ *
+ * Highest priority first, the oldest frame on equal priority. Frames
+ * queued within the same tick go in queue order, which keeps a sequence
+ * in order. Sequence frames wait until the previous one is sent.
+ */
+uint8_t can_tx_next(can_tx_queue_t* queue, uint16_t now)
+{
+   uint8_t best = CAN_TX_NONE;
+   uint8_t i;
+
+   for(i = 0; i < queue->count; ++i)
+   {
+      can_tx_entry_t* entry = &queue->entry[i];
+
+      if((CAN_TX_SEQUENCE == entry->mode) && (0 != queue->inFlightSeq))
+      {
+         continue;
+      }
+
+      if((CAN_TX_NONE == best) ||
+         (entry->prio > queue->entry[best].prio) ||
+         ((entry->prio == queue->entry[best].prio) &&
+          ((uint16_t)(now - entry->queued) >
+           (uint16_t)(now - queue->entry[best].queued))))
+      {
+         best = i;
+      }
+   }
+
+   return best;
+}
+
+/**
+ * \brief choose a free transmit buffer for a frame
+ * \param queue - pointer to queue of chip
+ * \param free - free transmit buffers (bit mask, not 0)
+ * \param msg - frame to load
+ * \return transmit buffer
+ *
+ * A buffer holding the same id is preferred, it needs the least transfer.
+ */
+uint8_t can_tx_buffer(can_tx_queue_t* queue, uint8_t free, can_t* msg)
+{
+   uint8_t buffer;
+   uint8_t first = MCP_NUM_TX_BUFFERS;
+
+   for(buffer = 0; buffer < MCP_NUM_TX_BUFFERS; ++buffer)
+   {
+      if(free & (1 << buffer))
+      {
+         if((0 != queue->shadow) &&
+            (queue->shadow->valid & (1 << buffer)) &&
+            (queue->shadow->frame[buffer].msgId == msg->msgId))
+         {
+            return buffer;
+         }
+         if(MCP_NUM_TX_BUFFERS == first)
+         {
+            first = buffer;
+         }
+      }
+   }
+
+   return first;
+}
+
+/**
+ * \brief load a frame into a transmit buffer and request to send it
+ * \param chip - selected MCP2515
+ * \param queue - pointer to queue of chip
+ * \param buffer - free transmit buffer
+ * \param entry - frame to load
+ * \return true, if the buffer held the frame already
+ *
+ * Only bytes differing from the shadow of the buffer are transferred. A
+ * chip without shadow gets the frame and its priority loaded completely.
+ */
+bool can_tx_load(eChipSelect     chip,
+                 can_tx_queue_t* queue,
+                 uint8_t         buffer,
+                 can_tx_entry_t* entry)
+{
+   can_tx_shadow_t* shadows = queue->shadow;
+   can_t*           msg     = &entry->msg;
+   can_t*           shadow  = 0;
+   bool             valid   = false;
+   uint8_t          first   = msg->header.len;
+   uint8_t          count   = 0;
+   bool             header;
+   uint8_t          i;
+
+   if(0 != shadows)
+   {
+      shadow = &shadows->frame[buffer];
+      valid  = (0 != (shadows->valid & (1 << buffer)));
+   }
+
+   // changed data bytes, bytes after the len of the shadow are unknown
+   for(i = 0; i < msg->header.len; ++i)
+   {
+      if((false == valid) || (i >= shadow->header.len) ||
+         (msg->data[i] != shadow->data[i]))
+      {
+         if(first == msg->header.len)
+         {
+            first = i;
+         }
+         count = i + 1;
+      }
+   }
+
+   header = (false == valid) || (msg->msgId != shadow->msgId) ||
+            (msg->header.rtr != shadow->header.rtr) ||
+            (msg->header.len != shadow->header.len);
+
+   if(true == header)
+   {
+      mcp2515_spi_loadTxBuffer(chip, buffer, msg, count);
+   }
+   else if(0 != count)
+   {
+      mcp2515_spi_loadTxData(chip, buffer, first, &msg->data[first],
+                             count - first);
+   }
+
+   if((false == valid) || (entry->prio != shadows->prio[buffer]))
+   {
+      mcp2515_spi_bitModify(chip, MCP_REG_TXBCTRL(buffer),
+                            MCP_TXP_MASK, entry->prio);
+   }
+
+   mcp2515_spi_requestToSend(chip, buffer);
+
+   if(0 != shadows)
+   {
+      *shadow                = *msg;
+      shadows->prio[buffer]  = entry->prio;
+      shadows->valid        |= (1 << buffer);
+   }
+
+   return (false == header) && (0 == count);
+}
+
+/**
+ * \brief remove frame from queue
+ * \param queue - pointer to queue of chip
+ * \param index - index of frame
+ *
+ * Later frames move down, so the queue order is kept.
+ */
+void can_tx_remove(can_tx_queue_t* queue, uint8_t index)
+{
+   --queue->count;
+   for(; index < queue->count; ++index)
+   {
+      queue->entry[index] = queue->entry[index + 1];
+   }
+}
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief initialize transmission of a chip
+ * \param chip - selected MCP2515
+ *
+ * Sets one shot mode according to CAN_TX_ONE_SHOT_CHIPS and empties the
+ * queue. Call after the chip is initialized or woken up. A suspension and
+ * a forced one shot mode are kept, see can_tx_resume()/can_tx_setOneShot().
+ */
+void can_tx_init(eChipSelect chip)
+{
+   can_tx_queue_t* queue = &can_tx_queues[chip];
+
+   queue->count       = 0;
+   queue->inFlight    = 0;
+   queue->inFlightSeq = 0;
+   // buffers may be reset by (re)initialization of the chip
+   if(0 != queue->shadow)
+   {
+      queue->shadow->valid = 0;
+   }
+   can_tx_stats[chip].depth = 0;
+
+   can_tx_setOneShot(chip, queue->oneShot);
+}
+
+/**
+ * \brief force one shot mode of a chip
+ * \param chip - selected MCP2515
+ * \param oneShot - true: send each frame once only; false: as configured
+ *                  by CAN_TX_ONE_SHOT_CHIPS
+ *
+ * E.g. while error passive, since retrying unacknowledged frames only
+ * occupies the bus and the transmit buffers.
+ */
+void can_tx_setOneShot(eChipSelect chip, bool oneShot)
+{
+   can_tx_queues[chip].oneShot = oneShot;
+
+   can_rx_lock();
+   mcp2515_spi_writeBits(chip, MCP_REG_CANCTRL, (1 << MCP_OSM),
+                         ((true == oneShot) ||
+                          (CAN_TX_ONE_SHOT_CHIPS & (1 << chip))) ?
+                         (1 << MCP_OSM) : 0);
+   can_rx_unlock();
+}
+
+/**
+ * \brief suspend transmission of a chip, e.g. while bus off
+ * \param chip - selected MCP2515
+ *
+ * Aborts all pending transmit buffers and drops the queued frames. Until
+ * can_tx_resume() every frame to send is dropped at once, so nothing waits
+ * for a bus not accepting it.
+ */
+void can_tx_suspend(eChipSelect chip)
+{
+   can_tx_queue_t* queue = &can_tx_queues[chip];
+   can_tx_stats_t* stats = &can_tx_stats[chip];
+
+   can_rx_lock();
+   // ABAT stays set, the chip is initialized again to resume
+   mcp2515_spi_writeBits(chip, MCP_REG_CANCTRL, (1 << MCP_ABAT),
+                         (1 << MCP_ABAT));
+   can_rx_unlock();
+
+   if((UINT16_MAX - stats->suspended) < queue->count)
+   {
+      stats->suspended = UINT16_MAX;
+   }
+   else
+   {
+      stats->suspended += queue->count;
+   }
+
+   queue->count       = 0;
+   queue->inFlight    = 0;
+   queue->inFlightSeq = 0;
+   queue->suspended   = true;
+   if(0 != queue->shadow)
+   {
+      queue->shadow->valid = 0;
+   }
+   stats->depth       = 0;
+}
+
+/**
+ * \brief resume suspended transmission of a chip
+ * \param chip - selected MCP2515
+ */
+void can_tx_resume(eChipSelect chip)
+{
+   can_tx_queues[chip].suspended = false;
+}
+
+/**
+ * \brief queue a frame for transmission and return at once
+ * \param chip - selected MCP2515
+ * \param msg - pointer to CAN message (copied)
+ * \param prio - importance of frame
+ * \param mode - cyclic frame or part of a sequence
+ * \param lifetime - time to send the frame (units of sched_getTime())
+ * \return false, if the frame was dropped
+ *
+ * A queued cyclic frame with the same id is replaced, since only the
+ * newest content is of interest. Sequence frames keep their order.
+ */
+bool can_tx_send(eChipSelect   chip,
+                 can_t*        msg,
+                 can_tx_prio_t prio,
+                 can_tx_mode_t mode,
+                 uint16_t      lifetime)
+{
+   can_tx_queue_t* queue = &can_tx_queues[chip];
+   can_tx_stats_t* stats = &can_tx_stats[chip];
+   can_tx_entry_t* entry = 0;
+   uint8_t i;
+
+   if(true == queue->suspended)
+   {
+      can_tx_increment(&stats->suspended);
+      return false;
+   }
+
+   if(CAN_TX_CYCLIC == mode)
+   {
+      for(i = 0; i < queue->count; ++i)
+      {
+         if((CAN_TX_CYCLIC == queue->entry[i].mode) &&
+            (msg->msgId == queue->entry[i].msg.msgId))
+         {
+            entry = &queue->entry[i];
+            can_tx_increment(&stats->replaced);
+            break;
+         }
+      }
+   }
+
+   if((0 == entry) && (queue->count < queue->size))
+   {
+      entry = &queue->entry[queue->count++];
+   }
+
+   if(0 == entry)
+   {
+      can_tx_increment(&stats->dropped);
+      return false;
+   }
+
+   entry->msg      = *msg;
+   entry->queued   = sched_getTime();
+   entry->lifetime = lifetime;
+   entry->prio     = prio;
+   entry->mode     = mode;
+
+   stats->depth = queue->count;
+   if(stats->depth > stats->maxDepth)
+   {
+      stats->maxDepth = stats->depth;
+   }
+
+   // load it right now, if a transmit buffer is free
+   can_tx_service(chip);
+
+   return true;
+}
+
+/**
+ * \brief load free transmit buffers and abort stale frames
+ * \param chip - selected MCP2515
+ *
+ * To be called every main loop pass.
+ */
+void can_tx_service(eChipSelect chip)
+{
+   can_tx_queue_t* queue = &can_tx_queues[chip];
+   can_tx_stats_t* stats = &can_tx_stats[chip];
+   uint16_t now;
+   uint16_t wait;
+   uint8_t  status;
+   uint8_t  buffer;
+   uint8_t  next;
+   uint8_t  free = 0;
+
+   // nothing to do, so no need to ask the chip
+   if((0 == queue->count) && (0 == queue->inFlight))
+   {
+      return;
+   }
+
+   now = sched_getTime();
+
+   can_rx_lock();
+   status = mcp2515_spi_readStatus(chip);
+
+   for(buffer = 0; buffer < MCP_NUM_TX_BUFFERS; ++buffer)
+   {
+      if(status & MCP_STATUS_TXREQ(buffer))
+      {
+         // still pending - abort, if the frame is stale
+         if((queue->inFlight & (1 << buffer)) &&
+            ((uint16_t)(now - queue->loaded[buffer]) > queue->lifetime[buffer]))
+         {
+            mcp2515_spi_bitModify(chip, MCP_REG_TXBCTRL(buffer),
+                                  (1 << MCP_TXREQ), 0);
+            queue->inFlight    &= ~(1 << buffer);
+            queue->inFlightSeq &= ~(1 << buffer);
+            can_tx_increment(&stats->aborted);
+         }
+         continue;
+      }
+
+      // buffer is free (again)
+      queue->inFlight    &= ~(1 << buffer);
+      queue->inFlightSeq &= ~(1 << buffer);
+      free               |=  (1 << buffer);
+   }
+
+   next = (0 != free) ? can_tx_next(queue, now) : CAN_TX_NONE;
+   while(CAN_TX_NONE != next)
+   {
+      can_tx_entry_t* entry = &queue->entry[next];
+
+      wait = now - entry->queued;
+      if(wait > stats->maxWait)
+      {
+         stats->maxWait = wait;
+      }
+
+      if(wait <= entry->lifetime)
+      {
+         buffer = can_tx_buffer(queue, free, &entry->msg);
+         if(true == can_tx_load(chip, queue, buffer, entry))
+         {
+            can_tx_increment(&stats->reused);
+         }
+
+         free                   &= ~(1 << buffer);
+         queue->inFlight        |= (1 << buffer);
+         if(CAN_TX_SEQUENCE == entry->mode)
+         {
+            queue->inFlightSeq  |= (1 << buffer);
+         }
+         queue->loaded[buffer]   = now;
+         queue->lifetime[buffer] = entry->lifetime - wait;
+         can_tx_increment(&stats->loaded);
+#ifdef PROFILE_ENABLE
+         if(0 != queue->hook)
+         {
+            queue->hook(&entry->msg);
+         }
+#endif
+      }
+      else
+      {
+         // stale before it got a buffer
+         can_tx_increment(&stats->aborted);
+      }
+
+      can_tx_remove(queue, next);
+      next = (0 != free) ? can_tx_next(queue, now) : CAN_TX_NONE;
+   }
+
+   can_rx_unlock();
+
+   stats->depth = queue->count;
+}
+
+#ifdef PROFILE_ENABLE
+/**
+ * \brief set hook called for each frame loaded into a transmit buffer
+ * \param chip - selected MCP2515
+ * \param hook - function to call (0 - none)
+ *
+ * The hook is called by can_tx_service() with the reception interrupt
+ * locked, so it should be short.
+ */
+void can_tx_setHook(eChipSelect chip, can_tx_hook_t hook)
+{
+   can_tx_queues[chip].hook = hook;
+}
+#endif
+
+/**
+ * \brief check for frames to load or in flight
+ * \param chip - selected MCP2515
+ * \return true, if can_tx_service() has nothing to do
+ */
+bool can_tx_isIdle(eChipSelect chip)
+{
+   return (0 == can_tx_queues[chip].count) &&
+          (0 == can_tx_queues[chip].inFlight);
+}
+
+/**
+ * \brief get transmit statistics of a chip
+ * \param chip - selected MCP2515
+ * \return pointer to statistics
+ */
+can_tx_stats_t* can_tx_getStats(eChipSelect chip)
+{
+   return &can_tx_stats[chip];
+}
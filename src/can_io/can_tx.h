@@ -0,0 +1,250 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file can_tx.h
+ *
+ * Non-blocking CAN transmission. Each chip has a small queue of frames
+ * waiting for one of the three MCP2515 transmit buffers. The priority of a
+ * frame is mapped to the TXP bits, so the MCP2515 sends the most important
+ * loaded frame first. A frame not sent within its lifetime is aborted,
+ * since a stale cyclic frame is worthless. Transmission of a chip may be
+ * suspended, e.g. while bus off (see can_fault.h).
+ *
+ * A shadow of each transmit buffer of CAN_TX_SHADOW_CHIP keeps what was
+ * loaded last. A frame is loaded into a free buffer holding the same id,
+ * if there is one, and only the bytes differing from the shadow are
+ * transferred. An unchanged frame
+ * takes the RTS instruction only (1 byte instead of 15 bytes for 8 data
+ * bytes plus 4 bytes to set the priority).
+ *
+ * With PROFILE_ENABLE a hook may be set per chip, which is called for each
+ * frame loaded into a transmit buffer, e.g. to timestamp it.
+ *
+ * \date Created: 16.10.2026 20:36:41
+ * \author agent
+ **/
+
+
+#ifndef CAN_TX_H_
+#define CAN_TX_H_
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \addtogroup can_tx_definitions Non-Blocking CAN Transmission
+ * \brief definitions for the transmit queues
+ * @{
+ */
+
+/**
+ * \def CAN_TX_QUEUE_SIZE_CHIP1
+ * \brief number of frames waiting for a transmit buffer of CAN1 (master)
+ *
+ * \def CAN_TX_QUEUE_SIZE_CHIP2
+ * \brief number of frames waiting for a transmit buffer of CAN2 (slave)
+ *
+ * CAN1 carries the sequences of the instrument cluster communication only,
+ * which are sent one frame at a time. CAN2 gets all cyclic messages, e.g.
+ * as a burst after wake up.
+ */
+#define CAN_TX_QUEUE_SIZE_CHIP1     2
+#define CAN_TX_QUEUE_SIZE_CHIP2     4
+
+/**
+ * \def CAN_TX_SHADOW_CHIP
+ * \brief chip keeping a shadow of its transmit buffers
+ *
+ * Only frames repeated with the same id gain by the shadow, which are the
+ * cyclic messages of CAN2. Frames of other chips are loaded completely.
+ */
+#define CAN_TX_SHADOW_CHIP          CAN_CHIP2
+
+/**
+ * \def CAN_TX_ONE_SHOT_CHIPS
+ * \brief chips using MCP2515 one shot mode (bit mask of eChipSelect)
+ *
+ * In one shot mode a frame is sent only once, regardless of errors or lost
+ * arbitration. Otherwise the lifetime of a frame bounds the retries.
+ */
+#define CAN_TX_ONE_SHOT_CHIPS       0
+
+/**
+ * \def CAN_TX_LIFETIME_DEFAULT
+ * \brief lifetime of sequence frames (units of sched_getTime())
+ */
+#define CAN_TX_LIFETIME_DEFAULT     SCHED_MS2TIME(1000)
+
+/*! @} */
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief importance of a frame, mapped to MCP2515 TXP bits
+ */
+typedef enum
+{
+   //! lowest priority, e.g. configuration
+   CAN_TX_PRIO_LOW     = 0,
+   //! intermediate low priority, e.g. cyclic status
+   CAN_TX_PRIO_NORMAL  = 1,
+   //! intermediate high priority, e.g. state changes
+   CAN_TX_PRIO_HIGH    = 2,
+   //! highest priority, e.g. safety relevant
+   CAN_TX_PRIO_HIGHEST = 3
+} can_tx_prio_t;
+
+/**
+ * \brief kind of traffic a frame belongs to
+ */
+typedef enum
+{
+   //! cyclic frame, a queued frame of the same id is replaced
+   CAN_TX_CYCLIC   = 0,
+   //! part of a sequence, sent in order and one at a time
+   CAN_TX_SEQUENCE = 1
+} can_tx_mode_t;
+
+/**
+ * \brief transmit statistics of one chip
+ *
+ * Counters saturate instead of wrapping around. Times are in units of
+ * sched_getTime().
+ */
+typedef struct
+{
+   //! frames loaded into a transmit buffer
+   uint16_t loaded;
+   //! frames sent again without loading, since the buffer held the same
+   uint16_t reused;
+   //! frames dropped, since the queue was full
+   uint16_t dropped;
+   //! queued frames replaced by a newer one of the same id
+   uint16_t replaced;
+   //! frames aborted after their lifetime
+   uint16_t aborted;
+   //! frames dropped, since transmission was suspended (e.g. bus off)
+   uint16_t suspended;
+   //! worst time a frame waited in the queue
+   uint16_t maxWait;
+   //! current number of queued frames
+   uint8_t  depth;
+   //! maximum number of queued frames
+   uint8_t  maxDepth;
+} can_tx_stats_t;
+
+#ifdef PROFILE_ENABLE
+/**
+ * \brief hook called for each frame loaded, see can_tx_setHook()
+ * \param msg - frame loaded
+ */
+typedef void (*can_tx_hook_t)(can_t* msg);
+#endif
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief initialize transmission of a chip
+ * \param chip - selected MCP2515
+ *
+ * Sets one shot mode according to CAN_TX_ONE_SHOT_CHIPS and empties the
+ * queue. Call after the chip is initialized or woken up. A suspension and
+ * a forced one shot mode are kept, see can_tx_resume()/can_tx_setOneShot().
+ */
+void can_tx_init(eChipSelect chip);
+
+/**
+ * \brief force one shot mode of a chip
+ * \param chip - selected MCP2515
+ * \param oneShot - true: send each frame once only; false: as configured
+ *                  by CAN_TX_ONE_SHOT_CHIPS
+ *
+ * E.g. while error passive, since retrying unacknowledged frames only
+ * occupies the bus and the transmit buffers.
+ */
+void can_tx_setOneShot(eChipSelect chip, bool oneShot);
+
+/**
+ * \brief suspend transmission of a chip, e.g. while bus off
+ * \param chip - selected MCP2515
+ *
+ * Aborts all pending transmit buffers and drops the queued frames. Until
+ * can_tx_resume() every frame to send is dropped at once, so nothing waits
+ * for a bus not accepting it.
+ */
+void can_tx_suspend(eChipSelect chip);
+
+/**
+ * \brief resume suspended transmission of a chip
+ * \param chip - selected MCP2515
+ */
+void can_tx_resume(eChipSelect chip);
+
+/**
+ * \brief queue a frame for transmission and return at once
+ * \param chip - selected MCP2515
+ * \param msg - pointer to CAN message (copied)
+ * \param prio - importance of frame
+ * \param mode - cyclic frame or part of a sequence
+ * \param lifetime - time to send the frame (units of sched_getTime())
+ * \return false, if the frame was dropped
+ *
+ * A queued cyclic frame with the same id is replaced, since only the
+ * newest content is of interest. Sequence frames keep their order.
+ */
+bool can_tx_send(eChipSelect   chip,
+                 can_t*        msg,
+                 can_tx_prio_t prio,
+                 can_tx_mode_t mode,
+                 uint16_t      lifetime);
+
+/**
+ * \brief load free transmit buffers and abort stale frames
+ * \param chip - selected MCP2515
+ *
+ * To be called every main loop pass.
+ */
+void can_tx_service(eChipSelect chip);
+
+/**
+ * \brief check for frames to load or in flight
+ * \param chip - selected MCP2515
+ * \return true, if can_tx_service() has nothing to do
+ */
+bool can_tx_isIdle(eChipSelect chip);
+
+/**
+ * \brief get transmit statistics of a chip
+ * \param chip - selected MCP2515
+ * \return pointer to statistics
+ */
+can_tx_stats_t* can_tx_getStats(eChipSelect chip);
+
+#ifdef PROFILE_ENABLE
+/**
+ * \brief set hook called for each frame loaded into a transmit buffer
+ * \param chip - selected MCP2515
+ * \param hook - function to call (0 - none)
+ *
+ * The hook is called by can_tx_service() with the reception interrupt
+ * locked, so it should be short.
+ */
+void can_tx_setHook(eChipSelect chip, can_tx_hook_t hook);
+#endif
+
+#endif /* CAN_TX_H_ */
@@ -0,0 +1,473 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file mcp2515_spi.c
+ *
+ * \date Created: 16.10.2026 20:32:43
+ * \author agent
+ **/
+
+
+#include <util/atomic.h>
+
+#include "../modules/can/can_mcp2515.h"
+#include "../modules/spi/spi.h"
+#include "../modules/config/spi_config.h"
+
+#include "mcp2515_spi.h"
+
+/***************************************************************************/
+/* VARIABLES                                                               */
+/***************************************************************************/
+
+//! bytes of the transfer in progress
+uint8_t mcp2515_spiTransfer = 0;
+
+//! bytes transferred since last sample for each chip
+volatile uint16_t mcp2515_spiBytes[NUM_OF_MCP2515];
+
+//! transactions of current main loop pass for each chip
+volatile uint8_t mcp2515_spiTransactions[NUM_OF_MCP2515];
+
+//! SPI statistics for each chip
+mcp2515_spi_stats_t mcp2515_spiStats[NUM_OF_MCP2515];
+
+//! registers shadowed, see mcp2515_spi_writeBits()
+const uint8_t mcp2515_spiShadowRegs[MCP_SPI_NUM_SHADOWS] =
+{
+   MCP_REG_CANCTRL, MCP_REG_CANINTE, MCP_REG_BFPCTRL,
+   MCP_REG_RXB0CTRL, MCP_REG_RXB1CTRL
+};
+
+//! shadowed register values for each chip
+uint8_t mcp2515_spiShadow[NUM_OF_MCP2515][MCP_SPI_NUM_SHADOWS];
+
+//! bits of shadowed registers known for each chip
+uint8_t mcp2515_spiKnown[NUM_OF_MCP2515][MCP_SPI_NUM_SHADOWS];
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief pull chip select of MCP2515 low
+ * \param chip - selected MCP2515
+ */
+void mcp2515_spi_select(eChipSelect chip)
+{
+   portaccess_t* cs = getCSPort(chip);
+   *(cs->port) &= ~(1 << cs->pin);
+}
+
+/**
+ * \brief release chip select of MCP2515
+ * \param chip - selected MCP2515
+ *
+ * Adds the bytes of the transfer to the count of the chip.
+ */
+void mcp2515_spi_unselect(eChipSelect chip)
+{
+   portaccess_t* cs = getCSPort(chip);
+   *(cs->port) |= (1 << cs->pin);
+
+   if((UINT16_MAX - mcp2515_spiTransfer) < mcp2515_spiBytes[chip])
+   {
+      mcp2515_spiBytes[chip] = UINT16_MAX;
+   }
+   else
+   {
+      mcp2515_spiBytes[chip] += mcp2515_spiTransfer;
+   }
+   mcp2515_spiTransfer = 0;
+
+   if(UINT8_MAX != mcp2515_spiTransactions[chip])
+   {
+      ++mcp2515_spiTransactions[chip];
+   }
+}
+
+/**
+ * \brief transfer a byte to the selected MCP2515 and count it
+ * \param data - byte to send
+ * \return byte received
+ */
+uint8_t mcp2515_spi_putc(uint8_t data)
+{
+   ++mcp2515_spiTransfer;
+   return spi_putc(data);
+}
+
+/**
+ * \brief write a register of the MCP2515
+ * \param chip - selected MCP2515
+ * \param address - register address
+ * \param data - value to write
+ */
+void mcp2515_spi_writeRegister(eChipSelect chip, uint8_t address, uint8_t data)
+{
+   mcp2515_spi_select(chip);
+   mcp2515_spi_putc(MCP_INSTR_WRITE);
+   mcp2515_spi_putc(address);
+   mcp2515_spi_putc(data);
+   mcp2515_spi_unselect(chip);
+}
+
+/**
+ * \brief read a register of the MCP2515
+ * \param chip - selected MCP2515
+ * \param address - register address
+ * \return register value
+ */
+uint8_t mcp2515_spi_readRegister(eChipSelect chip, uint8_t address)
+{
+   uint8_t data;
+
+   mcp2515_spi_select(chip);
+   mcp2515_spi_putc(MCP_INSTR_READ);
+   mcp2515_spi_putc(address);
+   data = mcp2515_spi_putc(0xFF);
+   mcp2515_spi_unselect(chip);
+
+   return data;
+}
+
+/**
+ * \brief write bits of a register, unless the shadow holds them already
+ * \param chip - selected MCP2515
+ * \param address - register address (bit modify capable for mask != 0xFF)
+ * \param mask - bits to write
+ * \param data - new value of bits
+ */
+void mcp2515_spi_writeBits(eChipSelect chip,
+                           uint8_t     address,
+                           uint8_t     mask,
+                           uint8_t     data)
+{
+   uint8_t slot;
+
+   for(slot = 0; slot < MCP_SPI_NUM_SHADOWS; ++slot)
+   {
+      if(address == mcp2515_spiShadowRegs[slot])
+      {
+         break;
+      }
+   }
+
+   if((MCP_SPI_NUM_SHADOWS != slot) &&
+      (mask == (mcp2515_spiKnown[chip][slot] & mask)) &&
+      (0 == ((mcp2515_spiShadow[chip][slot] ^ data) & mask)))
+   {
+      if(UINT16_MAX != mcp2515_spiStats[chip].skippedWrites)
+      {
+         ++mcp2515_spiStats[chip].skippedWrites;
+      }
+      return;
+   }
+
+   if(0xFF == mask)
+   {
+      mcp2515_spi_writeRegister(chip, address, data);
+   }
+   else
+   {
+      mcp2515_spi_bitModify(chip, address, mask, data);
+   }
+
+   if(MCP_SPI_NUM_SHADOWS != slot)
+   {
+      mcp2515_spiShadow[chip][slot] = (mcp2515_spiShadow[chip][slot] & ~mask) |
+                                      (data & mask);
+      mcp2515_spiKnown[chip][slot] |= mask;
+   }
+}
+
+/**
+ * \brief forget the shadowed registers of a chip
+ * \param chip - selected MCP2515
+ *
+ * Call whenever the CAN module accesses the registers, e.g. before init,
+ * sleep or wake up.
+ */
+void mcp2515_spi_forget(eChipSelect chip)
+{
+   uint8_t slot;
+
+   for(slot = 0; slot < MCP_SPI_NUM_SHADOWS; ++slot)
+   {
+      mcp2515_spiKnown[chip][slot] = 0;
+   }
+}
+
+/**
+ * \brief request an operation mode and wait for it
+ * \param chip - selected MCP2515
+ * \param mode - requested mode (REQOP bits, e.g. MCP_OPMOD_NORMAL)
+ * \return true, if mode was reached within MCP_SPI_MODE_POLLS reads
+ */
+bool mcp2515_spi_setMode(eChipSelect chip, uint8_t mode)
+{
+   uint8_t polls = MCP_SPI_MODE_POLLS;
+
+   mcp2515_spi_writeBits(chip, MCP_REG_CANCTRL, MCP_OPMOD_MASK, mode);
+
+   while(0 != polls--)
+   {
+      if(mode == (mcp2515_spi_readRegister(chip, MCP_REG_CANSTAT) &
+                  MCP_OPMOD_MASK))
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+/**
+ * \brief modify bits of a register by BIT MODIFY instruction
+ * \param chip - selected MCP2515
+ * \param address - register address (bit modify capable only)
+ * \param mask - bits to change
+ * \param data - new value of bits
+ */
+void mcp2515_spi_bitModify(eChipSelect chip,
+                           uint8_t     address,
+                           uint8_t     mask,
+                           uint8_t     data)
+{
+   mcp2515_spi_select(chip);
+   mcp2515_spi_putc(MCP_INSTR_BIT_MODIFY);
+   mcp2515_spi_putc(address);
+   mcp2515_spi_putc(mask);
+   mcp2515_spi_putc(data);
+   mcp2515_spi_unselect(chip);
+}
+
+/**
+ * \brief get status by READ STATUS instruction
+ * \param chip - selected MCP2515
+ * \return status byte (see MCP_STATUS_*)
+ */
+uint8_t mcp2515_spi_readStatus(eChipSelect chip)
+{
+   uint8_t status;
+
+   mcp2515_spi_select(chip);
+   mcp2515_spi_putc(MCP_INSTR_READ_STATUS);
+   status = mcp2515_spi_putc(0xFF);
+   mcp2515_spi_unselect(chip);
+
+   return status;
+}
+
+/**
+ * \brief get receive status by RX STATUS instruction
+ * \param chip - selected MCP2515
+ * \return status byte (see MCP_RX_STATUS_*)
+ */
+uint8_t mcp2515_spi_rxStatus(eChipSelect chip)
+{
+   uint8_t status;
+
+   mcp2515_spi_select(chip);
+   mcp2515_spi_putc(MCP_INSTR_RX_STATUS);
+   status = mcp2515_spi_putc(0xFF);
+   // data is repeated, no need to read it twice
+   mcp2515_spi_unselect(chip);
+
+   return status;
+}
+
+/**
+ * \brief read a receive buffer of the MCP2515 into a CAN message
+ * \param chip - selected MCP2515
+ * \param buffer - receive buffer (0 - RXB0; 1 - RXB1)
+ * \param msg - pointer to CAN message to fill
+ *
+ * The READ RX BUFFER instruction clears the matching RXnIF flag when the
+ * chip select is released. Only standard frames are evaluated.
+ */
+void mcp2515_spi_readRxBuffer(eChipSelect chip, uint8_t buffer, can_t* msg)
+{
+   uint8_t sidh;
+   uint8_t sidl;
+   uint8_t len;
+   uint8_t i;
+
+   mcp2515_spi_select(chip);
+   mcp2515_spi_putc(MCP_INSTR_READ_RX_BUFFER | (buffer << 2));
+
+   sidh = mcp2515_spi_putc(0xFF);
+   sidl = mcp2515_spi_putc(0xFF);
+   // skip EID8 and EID0 - no extended frames supported
+   mcp2515_spi_putc(0xFF);
+   mcp2515_spi_putc(0xFF);
+   len  = mcp2515_spi_putc(0xFF) & 0x0F;
+
+   msg->msgId      = ((uint16_t)sidh << 3) | (sidl >> 5);
+   msg->header.rtr = (sidl & (1 << MCP_SIDL_SRR)) ? 1 : 0;
+   msg->header.len = (len > 8) ? 8 : len;
+
+   for(i = 0; i < msg->header.len; ++i)
+   {
+      msg->data[i] = mcp2515_spi_putc(0xFF);
+   }
+
+   // RXnIF is cleared by rising edge of chip select
+   mcp2515_spi_unselect(chip);
+}
+
+/**
+ * \brief load a CAN message into a transmit buffer of the MCP2515
+ * \param chip - selected MCP2515
+ * \param buffer - transmit buffer (0..2)
+ * \param msg - pointer to CAN message
+ * \param count - number of data bytes to load (0..len)
+ *
+ * Only standard frames are supported. Data bytes after count are left as
+ * they are, e.g. if they did not change since the last load.
+ */
+void mcp2515_spi_loadTxBuffer(eChipSelect chip,
+                              uint8_t     buffer,
+                              can_t*      msg,
+                              uint8_t     count)
+{
+   uint8_t i;
+
+   mcp2515_spi_select(chip);
+   mcp2515_spi_putc(MCP_INSTR_LOAD_TX_BUFFER | (buffer << 1));
+
+   mcp2515_spi_putc((uint8_t)(msg->msgId >> 3));
+   mcp2515_spi_putc((uint8_t)(msg->msgId << 5));
+   // EID8 and EID0 - no extended frames supported
+   mcp2515_spi_putc(0);
+   mcp2515_spi_putc(0);
+   mcp2515_spi_putc((msg->header.rtr << 6) | msg->header.len);
+
+   for(i = 0; i < count; ++i)
+   {
+      mcp2515_spi_putc(msg->data[i]);
+   }
+
+   mcp2515_spi_unselect(chip);
+}
+
+/**
+ * \brief write data bytes of a transmit buffer only
+ * \param chip - selected MCP2515
+ * \param buffer - transmit buffer (0..2)
+ * \param first - index of first data byte
+ * \param data - pointer to data to write
+ * \param count - number of bytes to write
+ *
+ * Uses LOAD TX BUFFER at TXBnD0 for the first byte and WRITE otherwise,
+ * whichever transfers less bytes.
+ */
+void mcp2515_spi_loadTxData(eChipSelect    chip,
+                            uint8_t        buffer,
+                            uint8_t        first,
+                            const uint8_t* data,
+                            uint8_t        count)
+{
+   mcp2515_spi_select(chip);
+
+   if(1 >= first)
+   {
+      // one instruction byte, rewriting data[0] costs no more than an address
+      count += first;
+      data  -= first;
+      mcp2515_spi_putc(MCP_INSTR_LOAD_TX_DATA | (buffer << 1));
+   }
+   else
+   {
+      mcp2515_spi_putc(MCP_INSTR_WRITE);
+      mcp2515_spi_putc(MCP_REG_TXBD0(buffer) + first);
+   }
+
+   while(0 != count--)
+   {
+      mcp2515_spi_putc(*data++);
+   }
+
+   mcp2515_spi_unselect(chip);
+}
+
+/**
+ * \brief request to send a transmit buffer
+ * \param chip - selected MCP2515
+ * \param buffer - transmit buffer (0..2)
+ */
+void mcp2515_spi_requestToSend(eChipSelect chip, uint8_t buffer)
+{
+   mcp2515_spi_select(chip);
+   mcp2515_spi_putc(MCP_INSTR_RTS | (1 << buffer));
+   mcp2515_spi_unselect(chip);
+}
+
+/**
+ * \brief sample SPI bytes per second and utilisation of all chips
+ *
+ * Periodic job of MCP_SPI_RATE_PERIOD_MS. A byte occupies the bus for
+ * 8 * SPI_PRESCALER cycles.
+ */
+void mcp2515_spi_sampleRate(void)
+{
+   mcp2515_spi_stats_t* stats = mcp2515_spiStats;
+   uint8_t              chip;
+
+   for(chip = 0; chip < NUM_OF_MCP2515; ++chip, ++stats)
+   {
+      // receive interrupts count too
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+      {
+         stats->bytesPerSecond  = mcp2515_spiBytes[chip];
+         mcp2515_spiBytes[chip] = 0;
+      }
+      stats->utilisation = (uint16_t)(
+         (uint32_t)stats->bytesPerSecond * (8 * SPI_PRESCALER) /
+         ((F_CPU / 1000000UL) * MCP_SPI_RATE_PERIOD_MS));
+   }
+}
+
+/**
+ * \brief count transactions of a main loop pass of all chips
+ *
+ * To be called once at the end of every main loop pass.
+ */
+void mcp2515_spi_countPass(void)
+{
+   mcp2515_spi_stats_t* stats = mcp2515_spiStats;
+   uint8_t              chip;
+
+   for(chip = 0; chip < NUM_OF_MCP2515; ++chip, ++stats)
+   {
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+      {
+         stats->transactionsLastPass   = mcp2515_spiTransactions[chip];
+         mcp2515_spiTransactions[chip] = 0;
+      }
+      if(stats->transactionsLastPass > stats->transactionsMaxPass)
+      {
+         stats->transactionsMaxPass = stats->transactionsLastPass;
+      }
+   }
+}
+
+/**
+ * \brief get SPI statistics of a chip
+ * \param chip - selected MCP2515
+ * \return pointer to statistics
+ */
+mcp2515_spi_stats_t* mcp2515_spi_getStats(eChipSelect chip)
+{
+   return &mcp2515_spiStats[chip];
+}
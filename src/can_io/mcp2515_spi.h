@@ -0,0 +1,508 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file mcp2515_spi.h
+ *
+ * Direct SPI access to the MCP2515 for the parts the CAN module does not
+ * provide, e.g. reading a dedicated receive buffer from interrupt context.
+ *
+ * All bytes transferred by these functions are counted per chip.
+ * mcp2515_spi_sampleRate() turns the count into bytes per second, transfers
+ * of the CAN module itself (initialization, sleep) are not part of it.
+ *
+ * The control registers written by this project (CANCTRL, CANINTE,
+ * BFPCTRL, RXB0CTRL, RXB1CTRL) are shadowed. mcp2515_spi_writeBits() skips
+ * the transfer, if the bits already hold the value, and uses BIT MODIFY
+ * (4 bytes) for some bits or WRITE (3 bytes) for all bits of a register.
+ * The shadow is unknown after the CAN module accessed the chip, e.g. init,
+ * sleep or wake up, see mcp2515_spi_forget().
+ *
+ * All transfers busy wait for each byte. Shifting the bytes by the SPI
+ * interrupt instead does not pay off: at SPI_PRESCALER 4 a byte takes 32
+ * cycles, less than entry and exit of an interrupt saving the registers it
+ * needs (~50 cycles), so the CPU would be busy longer than while waiting.
+ * The utilisation in mcp2515_spi_stats_t shows how much of the bus time is
+ * spent on the MCP2515 at all.
+ *
+ * \date Created: 16.10.2026 20:32:43
+ * \author agent
+ **/
+
+
+#ifndef MCP2515_SPI_H_
+#define MCP2515_SPI_H_
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \addtogroup mcp2515_spi_definitions Direct MCP2515 SPI Access
+ * \brief SPI instructions, registers and bits used for direct access
+ * @{
+ */
+
+/**
+ * \def MCP_INSTR_WRITE
+ * \brief write register(s) starting at given address
+ *
+ * \def MCP_INSTR_READ
+ * \brief read register(s) starting at given address
+ *
+ * \def MCP_INSTR_BIT_MODIFY
+ * \brief modify bits of a register by mask
+ *
+ * \def MCP_INSTR_LOAD_TX_BUFFER
+ * \brief load transmit buffer starting at TXBnSIDH (add buffer << 1)
+ *
+ * \def MCP_INSTR_LOAD_TX_DATA
+ * \brief load transmit buffer starting at TXBnD0 (add buffer << 1)
+ *
+ * \def MCP_INSTR_RTS
+ * \brief request to send (add 1 << buffer)
+ *
+ * \def MCP_INSTR_READ_RX_BUFFER
+ * \brief read receive buffer starting at RXBnSIDH (add buffer << 2)
+ *
+ * \def MCP_INSTR_READ_STATUS
+ * \brief quick read of interrupt and transmit status bits
+ *
+ * \def MCP_INSTR_RX_STATUS
+ * \brief quick read of receive status
+ */
+#define MCP_INSTR_WRITE             0x02
+#define MCP_INSTR_READ              0x03
+#define MCP_INSTR_BIT_MODIFY        0x05
+#define MCP_INSTR_LOAD_TX_BUFFER    0x40
+#define MCP_INSTR_LOAD_TX_DATA      0x41
+#define MCP_INSTR_RTS               0x80
+#define MCP_INSTR_READ_RX_BUFFER    0x90
+#define MCP_INSTR_READ_STATUS       0xA0
+#define MCP_INSTR_RX_STATUS         0xB0
+
+/**
+ * \def MCP_REG_BFPCTRL
+ * \brief RXnBF pin control register
+ *
+ * \def MCP_REG_CANINTE
+ * \brief interrupt enable register
+ *
+ * \def MCP_REG_CANINTF
+ * \brief interrupt flag register
+ *
+ * \def MCP_REG_EFLG
+ * \brief error flag register
+ *
+ * \def MCP_REG_TEC
+ * \brief transmit error counter
+ *
+ * \def MCP_REG_REC
+ * \brief receive error counter
+ *
+ * \def MCP_REG_RXB0CTRL
+ * \brief receive buffer 0 control register
+ *
+ * \def MCP_REG_CANCTRL
+ * \brief CAN control register
+ *
+ * \def MCP_REG_TXBCTRL
+ * \brief transmit buffer n control register (n = 0..2)
+ *
+ * \def MCP_REG_TXBD0
+ * \brief first data byte of transmit buffer n (n = 0..2)
+ *
+ * \def MCP_REG_CANSTAT
+ * \brief CAN status register
+ *
+ * \def MCP_REG_RXB1CTRL
+ * \brief receive buffer 1 control register
+ *
+ * \def MCP_REG_RXFSIDH
+ * \brief standard id high byte of acceptance filter n (n = 0..5)
+ *
+ * \def MCP_REG_RXMSIDH
+ * \brief standard id high byte of acceptance mask n (n = 0..1)
+ */
+#define MCP_REG_BFPCTRL             0x0C
+#define MCP_REG_CANINTE             0x2B
+#define MCP_REG_CANINTF             0x2C
+#define MCP_REG_EFLG                0x2D
+#define MCP_REG_TEC                 0x1C
+#define MCP_REG_REC                 0x1D
+#define MCP_REG_RXB0CTRL            0x60
+#define MCP_REG_CANCTRL             0x0F
+#define MCP_REG_TXBCTRL(n)          (0x30 + ((n) << 4))
+#define MCP_REG_TXBD0(n)            (0x36 + ((n) << 4))
+#define MCP_REG_CANSTAT             0x0E
+#define MCP_REG_RXB1CTRL            0x70
+#define MCP_REG_RXFSIDH(n)          (((n) < 3) ? ((n) << 2) : (0x10 + (((n) - 3) << 2)))
+#define MCP_REG_RXMSIDH(n)          (0x20 + ((n) << 2))
+
+/**
+ * \def MCP_NUM_FILTERS
+ * \brief number of acceptance filters RXF0..RXF5
+ *
+ * \def MCP_NUM_MASKS
+ * \brief number of acceptance masks RXM0..RXM1
+ */
+#define MCP_NUM_FILTERS             6
+#define MCP_NUM_MASKS               2
+
+/**
+ * \def MCP_OPMOD_MASK
+ * \brief CANCTRL: REQOP bits; CANSTAT: OPMOD bits
+ *
+ * \def MCP_OPMOD_NORMAL
+ * \brief normal operation mode
+ *
+ * \def MCP_OPMOD_CONFIG
+ * \brief configuration mode (masks and filters writable)
+ */
+#define MCP_OPMOD_MASK              0xE0
+#define MCP_OPMOD_NORMAL            0x00
+#define MCP_OPMOD_CONFIG            0x80
+
+/**
+ * \def MCP_RXM_MASK
+ * \brief RXBnCTRL: receive buffer operating mode bits (00 - use filters)
+ */
+#define MCP_RXM_MASK                0x60
+
+/**
+ * \def MCP_NUM_TX_BUFFERS
+ * \brief number of transmit buffers TXB0..TXB2
+ */
+#define MCP_NUM_TX_BUFFERS          3
+
+/**
+ * \def MCP_OSM
+ * \brief CANCTRL: one shot mode
+ *
+ * \def MCP_ABAT
+ * \brief CANCTRL: abort all pending transmissions
+ */
+#define MCP_OSM                     3
+#define MCP_ABAT                    4
+
+/**
+ * \def MCP_TXREQ
+ * \brief TXBnCTRL: message transmit request
+ *
+ * \def MCP_TXP_MASK
+ * \brief TXBnCTRL: transmit buffer priority bits
+ */
+#define MCP_TXREQ                   3
+#define MCP_TXP_MASK                0x03
+
+/**
+ * \def MCP_STATUS_TXREQ
+ * \brief READ STATUS: TXREQ bit of transmit buffer n (n = 0..2)
+ */
+#define MCP_STATUS_TXREQ(n)         (1 << (2 + ((n) << 1)))
+
+/**
+ * \def MCP_BUKT
+ * \brief RXB0CTRL: roll over to RXB1, if RXB0 is full
+ */
+#define MCP_BUKT                    2
+
+/**
+ * \def MCP_RX0OVR
+ * \brief EFLG: receive buffer 0 overflow
+ *
+ * \def MCP_RX1OVR
+ * \brief EFLG: receive buffer 1 overflow
+ */
+#define MCP_RX0OVR                  6
+#define MCP_RX1OVR                  7
+
+/**
+ * \def MCP_EWARN
+ * \brief EFLG: TEC or REC reached the warning limit (96)
+ *
+ * \def MCP_RXEP
+ * \brief EFLG: receive error passive (REC >= 128)
+ *
+ * \def MCP_TXEP
+ * \brief EFLG: transmit error passive (TEC >= 128)
+ *
+ * \def MCP_TXBO
+ * \brief EFLG: bus off (TEC reached 255)
+ */
+#define MCP_EWARN                   0
+#define MCP_RXEP                    3
+#define MCP_TXEP                    4
+#define MCP_TXBO                    5
+
+/**
+ * \def MCP_EFLG_ERRORS
+ * \brief EFLG: error warning, error passive and bus off bits
+ */
+#define MCP_EFLG_ERRORS             0x3F
+
+/**
+ * \def MCP_RX0IE
+ * \brief receive buffer 0 full interrupt enable
+ *
+ * \def MCP_RX1IE
+ * \brief receive buffer 1 full interrupt enable
+ */
+#define MCP_RX0IE                   0
+#define MCP_RX1IE                   1
+
+/**
+ * \def MCP_RX0IF
+ * \brief CANINTF: receive buffer 0 full
+ *
+ * \def MCP_RX1IF
+ * \brief CANINTF: receive buffer 1 full
+ */
+#define MCP_RX0IF                   0
+#define MCP_RX1IF                   1
+
+/**
+ * \def MCP_SIDL_SRR
+ * \brief standard frame remote transmit request bit in RXBnSIDL
+ */
+#define MCP_SIDL_SRR                4
+
+/**
+ * \def MCP_RX_STATUS_RXB0
+ * \brief RX STATUS: message in RXB0
+ *
+ * \def MCP_RX_STATUS_RXB1
+ * \brief RX STATUS: message in RXB1
+ *
+ * \def MCP_RX_STATUS_MSG_MASK
+ * \brief RX STATUS: mask for any received message
+ */
+#define MCP_RX_STATUS_RXB0          0x40
+#define MCP_RX_STATUS_RXB1          0x80
+#define MCP_RX_STATUS_MSG_MASK      0xC0
+
+/**
+ * \def MCP_SPI_RATE_PERIOD_MS
+ * \brief period of mcp2515_spi_sampleRate() in ms
+ */
+#define MCP_SPI_RATE_PERIOD_MS      1000
+
+/**
+ * \def MCP_SPI_NUM_SHADOWS
+ * \brief number of registers shadowed per chip
+ */
+#define MCP_SPI_NUM_SHADOWS         5
+
+/**
+ * \def MCP_SPI_MODE_POLLS
+ * \brief number of CANSTAT reads to wait for a mode change
+ *
+ * The MCP2515 changes into configuration mode after a pending transmission
+ * is done and out of sleep after its oscillator started. Keep it reasonable
+ * for the lowest bitrate.
+ */
+#define MCP_SPI_MODE_POLLS          250
+
+/*! @} */
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief SPI statistics of one chip
+ *
+ * Counters saturate instead of wrapping around.
+ */
+typedef struct
+{
+   //! bytes transferred during the last MCP_SPI_RATE_PERIOD_MS
+   uint16_t bytesPerSecond;
+   //! register writes skipped, since the shadow held the value
+   uint16_t skippedWrites;
+   //! SPI bus utilisation of the last period in per mille
+   uint16_t utilisation;
+   //! transactions (chip selects) during the last main loop pass
+   uint8_t  transactionsLastPass;
+   //! maximum transactions during a main loop pass
+   uint8_t  transactionsMaxPass;
+} mcp2515_spi_stats_t;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief pull chip select of MCP2515 low
+ * \param chip - selected MCP2515
+ */
+void mcp2515_spi_select(eChipSelect chip);
+
+/**
+ * \brief release chip select of MCP2515
+ * \param chip - selected MCP2515
+ *
+ * Adds the bytes of the transfer to the count of the chip.
+ */
+void mcp2515_spi_unselect(eChipSelect chip);
+
+/**
+ * \brief transfer a byte to the selected MCP2515 and count it
+ * \param data - byte to send
+ * \return byte received
+ */
+uint8_t mcp2515_spi_putc(uint8_t data);
+
+/**
+ * \brief write a register of the MCP2515
+ * \param chip - selected MCP2515
+ * \param address - register address
+ * \param data - value to write
+ */
+void mcp2515_spi_writeRegister(eChipSelect chip, uint8_t address, uint8_t data);
+
+/**
+ * \brief read a register of the MCP2515
+ * \param chip - selected MCP2515
+ * \param address - register address
+ * \return register value
+ */
+uint8_t mcp2515_spi_readRegister(eChipSelect chip, uint8_t address);
+
+/**
+ * \brief write bits of a register, unless the shadow holds them already
+ * \param chip - selected MCP2515
+ * \param address - register address (bit modify capable for mask != 0xFF)
+ * \param mask - bits to write
+ * \param data - new value of bits
+ */
+void mcp2515_spi_writeBits(eChipSelect chip,
+                           uint8_t     address,
+                           uint8_t     mask,
+                           uint8_t     data);
+
+/**
+ * \brief forget the shadowed registers of a chip
+ * \param chip - selected MCP2515
+ *
+ * Call whenever the CAN module accesses the registers, e.g. before init,
+ * sleep or wake up.
+ */
+void mcp2515_spi_forget(eChipSelect chip);
+
+/**
+ * \brief request an operation mode and wait for it
+ * \param chip - selected MCP2515
+ * \param mode - requested mode (REQOP bits, e.g. MCP_OPMOD_NORMAL)
+ * \return true, if mode was reached within MCP_SPI_MODE_POLLS reads
+ */
+bool mcp2515_spi_setMode(eChipSelect chip, uint8_t mode);
+
+/**
+ * \brief modify bits of a register by BIT MODIFY instruction
+ * \param chip - selected MCP2515
+ * \param address - register address (bit modify capable only)
+ * \param mask - bits to change
+ * \param data - new value of bits
+ */
+void mcp2515_spi_bitModify(eChipSelect chip,
+                           uint8_t     address,
+                           uint8_t     mask,
+                           uint8_t     data);
+
+/**
+ * \brief get status by READ STATUS instruction
+ * \param chip - selected MCP2515
+ * \return status byte (see MCP_STATUS_*)
+ */
+uint8_t mcp2515_spi_readStatus(eChipSelect chip);
+
+/**
+ * \brief get receive status by RX STATUS instruction
+ * \param chip - selected MCP2515
+ * \return status byte (see MCP_RX_STATUS_*)
+ */
+uint8_t mcp2515_spi_rxStatus(eChipSelect chip);
+
+/**
+ * \brief read a receive buffer of the MCP2515 into a CAN message
+ * \param chip - selected MCP2515
+ * \param buffer - receive buffer (0 - RXB0; 1 - RXB1)
+ * \param msg - pointer to CAN message to fill
+ *
+ * The READ RX BUFFER instruction clears the matching RXnIF flag when the
+ * chip select is released. Only standard frames are evaluated.
+ */
+void mcp2515_spi_readRxBuffer(eChipSelect chip, uint8_t buffer, can_t* msg);
+
+/**
+ * \brief load a CAN message into a transmit buffer of the MCP2515
+ * \param chip - selected MCP2515
+ * \param buffer - transmit buffer (0..2)
+ * \param msg - pointer to CAN message
+ * \param count - number of data bytes to load (0..len)
+ *
+ * Only standard frames are supported. Data bytes after count are left as
+ * they are, e.g. if they did not change since the last load.
+ */
+void mcp2515_spi_loadTxBuffer(eChipSelect chip,
+                              uint8_t     buffer,
+                              can_t*      msg,
+                              uint8_t     count);
+
+/**
+ * \brief write data bytes of a transmit buffer only
+ * \param chip - selected MCP2515
+ * \param buffer - transmit buffer (0..2)
+ * \param first - index of first data byte
+ * \param data - pointer to data to write
+ * \param count - number of bytes to write
+ *
+ * Uses LOAD TX BUFFER at TXBnD0 for the first byte and WRITE otherwise,
+ * whichever transfers less bytes.
+ */
+void mcp2515_spi_loadTxData(eChipSelect    chip,
+                            uint8_t        buffer,
+                            uint8_t        first,
+                            const uint8_t* data,
+                            uint8_t        count);
+
+/**
+ * \brief request to send a transmit buffer
+ * \param chip - selected MCP2515
+ * \param buffer - transmit buffer (0..2)
+ */
+void mcp2515_spi_requestToSend(eChipSelect chip, uint8_t buffer);
+
+/**
+ * \brief sample SPI bytes per second and utilisation of all chips
+ *
+ * Periodic job of MCP_SPI_RATE_PERIOD_MS. A byte occupies the bus for
+ * 8 * SPI_PRESCALER cycles.
+ */
+void mcp2515_spi_sampleRate(void);
+
+/**
+ * \brief count transactions of a main loop pass of all chips
+ *
+ * To be called once at the end of every main loop pass.
+ */
+void mcp2515_spi_countPass(void);
+
+/**
+ * \brief get SPI statistics of a chip
+ * \param chip - selected MCP2515
+ * \return pointer to statistics
+ */
+mcp2515_spi_stats_t* mcp2515_spi_getStats(eChipSelect chip);
+
+#endif /* MCP2515_SPI_H_ */
@@ -0,0 +1,252 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file comm_codec.h
+ *
+ * Access to signals at constant positions. Position, length, byte order and
+ * data length of a signal are compile time constants (COMM_SIG_x_... of
+ * comm_matrix_gen.h). The functions are always inlined and written without
+ * loops, so the compiler folds every access into the shift/mask sequence of
+ * hand written code, e.g.
+ * \code
+ * storage.wheelIn = COMM_CODEC_GET(msg->data,
+ *                                  COMM_SIG_1_WHEEL_GEAR_DATA_WHEEL_COUNT);
+ * \endcode
+ * becomes ((data[4] & 0x07) << 8) | data[3]. A signal not fitting into the
+ * data length of its message fails compilation.
+ *
+ * Checked on the host (gcc -Os): with constant parameters no loop or
+ * branch is left in the generated code. Size and cycles on the atmega8 are
+ * not measured yet, they are to be taken from avr-size and the listing of
+ * a firmware build. Expected from the instructions left: an aligned byte
+ * is one LD/ST (2 cycles) and an unaligned 16bit signal ~10 cycles, the
+ * same as the former hand code. comm_signal_extract()/comm_signal_insert()
+ * stay in use for the signals loaded at run time (comm_signals).
+ *
+ * \date Created: 16.10.2026 20:52:57
+ * \author agent
+ **/
+
+
+#ifndef COMM_CODEC_H_
+#define COMM_CODEC_H_
+
+#include <stdint.h>
+
+#include "comm_signal.h"
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \addtogroup comm_codec_definitions Signal Access at Constant Positions
+ * \brief macros to read and write signals described by comm_matrix_gen.h
+ * @{
+ */
+
+/**
+ * \def COMM_CODEC_FITS
+ * \brief constant expression: signal fits into data length of message
+ * \param start - least significant bit of signal
+ * \param length - length in bits (1..32)
+ * \param order - byte order
+ * \param dlc - data length of message
+ */
+#define COMM_CODEC_FITS(start, length, order, dlc)                         \
+   ((0 < (length)) && (32 >= (length)) && ((dlc) > ((start) >> 3)) &&     \
+    ((COMM_SIGNAL_INTEL == (order))                                        \
+       ? ((dlc) > (((start) + (length) - 1) >> 3))                         \
+       : (((start) >> 3) >= ((((start) & 7) + (length) - 1) >> 3))))
+
+/**
+ * \def COMM_CODEC_CHECK
+ * \brief fails compilation, if a signal does not fit into its message
+ */
+#define COMM_CODEC_CHECK(start, length, order, dlc)                        \
+   sizeof(char[COMM_CODEC_FITS(start, length, order, dlc) ? 1 : -1])
+
+/**
+ * \def COMM_CODEC_GET
+ * \brief read raw value of a signal
+ * \param data - message data
+ * \param signal - signal as start, length, order, dlc (COMM_SIG_x_...)
+ * \return raw value (uint32_t)
+ */
+#define COMM_CODEC_GET(data, signal)   COMM_CODEC_GET_(data, signal)
+
+/**
+ * \def COMM_CODEC_SET
+ * \brief write raw value of a signal, other bits are kept
+ * \param data - message data
+ * \param signal - signal as start, length, order, dlc (COMM_SIG_x_...)
+ * \param value - raw value (truncated to length)
+ */
+#define COMM_CODEC_SET(data, signal, value)                                \
+   COMM_CODEC_SET_(data, signal, value)
+
+//! expands signal description of COMM_CODEC_GET()
+#define COMM_CODEC_GET_(data, start, length, order, dlc)                   \
+   ((void)COMM_CODEC_CHECK(start, length, order, dlc),                     \
+    comm_codec_get((data), (start), (length), (order)))
+
+//! expands signal description of COMM_CODEC_SET()
+#define COMM_CODEC_SET_(data, start, length, order, dlc, value)            \
+   ((void)COMM_CODEC_CHECK(start, length, order, dlc),                     \
+    comm_codec_set((data), (start), (length), (order), (value)))
+
+/*! @} */
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+static inline uint32_t comm_codec_get(const uint8_t*      data,
+                                      uint8_t             start,
+                                      uint8_t             length,
+                                      comm_signal_order_t order)
+   __attribute__((always_inline));
+
+static inline void comm_codec_setByte(uint8_t* data,
+                                      uint8_t  mask,
+                                      uint8_t  value)
+   __attribute__((always_inline));
+
+static inline void comm_codec_set(uint8_t*            data,
+                                  uint8_t             start,
+                                  uint8_t             length,
+                                  comm_signal_order_t order,
+                                  uint32_t            value)
+   __attribute__((always_inline));
+
+/**
+ * \brief read raw value of a signal at a constant position
+ * \param data - message data
+ * \param start - least significant bit of signal
+ * \param length - length in bits (1..32)
+ * \param order - byte order
+ * \return raw value
+ *
+ * Use COMM_CODEC_GET() to get the position checked.
+ */
+static inline uint32_t comm_codec_get(const uint8_t*      data,
+                                      uint8_t             start,
+                                      uint8_t             length,
+                                      comm_signal_order_t order)
+{
+   const int8_t  step  = (COMM_SIGNAL_INTEL == order) ? 1 : -1;
+   const uint8_t index = start >> 3;
+   const uint8_t shift = start & 7;
+   uint32_t      value = data[index] >> shift;
+
+   // each further byte touched, all conditions are constant
+   if(shift + length > 8)
+   {
+      value |= (uint32_t)data[index + step] << (8 - shift);
+   }
+   if(shift + length > 16)
+   {
+      value |= (uint32_t)data[index + 2 * step] << (16 - shift);
+   }
+   if(shift + length > 24)
+   {
+      value |= (uint32_t)data[index + 3 * step] << (24 - shift);
+   }
+   if(shift + length > 32)
+   {
+      value |= (uint32_t)data[index + 4 * step] << (32 - shift);
+   }
+
+   if(length < 32)
+   {
+      value &= ((uint32_t)1 << length) - 1;
+   }
+
+   return value;
+}
+
+/**
+ * \brief write bits of a byte
+ * \param data - byte to write
+ * \param mask - bits to write
+ * \param value - new bits
+ *
+ * A full mask is a plain store.
+ */
+static inline void comm_codec_setByte(uint8_t* data,
+                                      uint8_t  mask,
+                                      uint8_t  value)
+{
+   if(0xFF == mask)
+   {
+      *data = value;
+   }
+   else
+   {
+      *data = (*data & ~mask) | (value & mask);
+   }
+}
+
+/**
+ * \brief write raw value of a signal at a constant position
+ * \param data - message data
+ * \param start - least significant bit of signal
+ * \param length - length in bits (1..32)
+ * \param order - byte order
+ * \param value - raw value (truncated to length)
+ *
+ * Use COMM_CODEC_SET() to get the position checked.
+ */
+static inline void comm_codec_set(uint8_t*            data,
+                                  uint8_t             start,
+                                  uint8_t             length,
+                                  comm_signal_order_t order,
+                                  uint32_t            value)
+{
+   const int8_t  step  = (COMM_SIGNAL_INTEL == order) ? 1 : -1;
+   const uint8_t index = start >> 3;
+   const uint8_t shift = start & 7;
+   // bits of signal after each byte
+   const uint8_t end   = shift + length;
+
+   comm_codec_setByte(&data[index],
+                      (uint8_t)(((end >= 8) ? 0xFF : ((1 << end) - 1)) &
+                                (0xFF << shift)),
+                      (uint8_t)(value << shift));
+   if(end > 8)
+   {
+      comm_codec_setByte(&data[index + step],
+                         (end >= 16) ? 0xFF : ((1 << (end - 8)) - 1),
+                         (uint8_t)(value >> (8 - shift)));
+   }
+   if(end > 16)
+   {
+      comm_codec_setByte(&data[index + 2 * step],
+                         (end >= 24) ? 0xFF : ((1 << (end - 16)) - 1),
+                         (uint8_t)(value >> (16 - shift)));
+   }
+   if(end > 24)
+   {
+      comm_codec_setByte(&data[index + 3 * step],
+                         (end >= 32) ? 0xFF : ((1 << (end - 24)) - 1),
+                         (uint8_t)(value >> (24 - shift)));
+   }
+   if(end > 32)
+   {
+      comm_codec_setByte(&data[index + 4 * step],
+                         (1 << (end - 32)) - 1,
+                         (uint8_t)(value >> (32 - shift)));
+   }
+}
+
+#endif /* COMM_CODEC_H_ */
@@ -0,0 +1,90 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file comm_dispatch.h
+ *
+ * Dispatch of CAN ids to their handlers. The cases of a switch over the id
+ * are expanded from the id registry in comm_matrix_gen.h, so the registry
+ * stays the only list of handled ids.
+ *
+ * A switch is kept instead of a binary search in a flash table. The
+ * compiler turns the sparse case values into a tree of compares against
+ * constants (LDI/CPI/CPC and a branch, ~5 cycles per level), while a step
+ * of the table search reads id and handler by LPM (3 cycles per byte) and
+ * computes the address of the row (~25 cycles per level). Both need about
+ * log2(n) levels, e.g. 3 for the 7 ids of CAN1.
+ *
+ * \date Created: 16.10.2026 20:42:09
+ * \author agent
+ **/
+
+
+#ifndef COMM_DISPATCH_H_
+#define COMM_DISPATCH_H_
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \addtogroup comm_dispatch_definitions CAN ID Dispatch
+ * \brief definitions for dispatching CAN ids
+ * @{
+ */
+
+/**
+ * \def COMM_DISPATCH_CASE
+ * \brief expands an entry of the id registry into a case setting a handler
+ * \param id - CAN id of entry
+ * \param function - decoder or encoder of entry
+ * \param handler - variable (comm_handler_t) set to function
+ *
+ * \def COMM_DISPATCH_CASE_DIRTY
+ * \brief expands an entry into a case setting a handler and a dirty mask
+ * \param id - CAN id of entry
+ * \param function - decoder or encoder of entry
+ * \param mask - dirty mask of entry
+ * \param handler - variable (comm_handler_t) set to function
+ * \param dirty - variable (uint8_t) set to mask
+ *
+ * The registry lists pass id, function and mask only, so the function
+ * containing a switch defines a case macro naming its own variables, e.g.
+ * \code
+ * #define COMM_FETCH_CAN1_CASE(id, function, mask) \
+ *    COMM_DISPATCH_CASE_DIRTY(id, function, mask, handler, dirty)
+ * \endcode
+ * \sa CANID_1_CONSUMED
+ */
+#define COMM_DISPATCH_CASE(id, function, handler)                    \
+   case id:                                                          \
+      handler = function;                                            \
+      break;
+
+#define COMM_DISPATCH_CASE_DIRTY(id, function, mask, handler, dirty) \
+   case id:                                                          \
+      handler = function;                                            \
+      dirty   = mask;                                                \
+      break;
+
+/*! @} */
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief decoder or encoder of a CAN message
+ */
+typedef void (*comm_handler_t)(can_t* msg);
+
+#endif /* COMM_DISPATCH_H_ */
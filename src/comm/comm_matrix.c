@@ -18,47 +18,43 @@
  **/
 
 
+#include <avr/io.h>
 #include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include <util/crc16.h>
+#include <stddef.h>
 
 #include "../modules/can/can_mcp2515.h"
+#include "../can_io/can_tx.h"
+#include "../sched/scheduler.h"
+#include "../sched/timebase.h"
+#include "../sched/profile.h"
 
 #include "comm_can_ids.h"
+#include "comm_dispatch.h"
+#include "comm_signal.h"
+#include "comm_codec.h"
 #include "comm_matrix.h"
+#include "comm_matrix_gen.h"
+#include "comm_persist.h"
+#include "comm_sleep.h"
+#include "comm_store.h"
+#include "comm_timing.h"
+#include "comm_tx.h"
 #include "ic_comm.h"
 
 /***************************************************************************/
 /* Definition of global variables to store CAN values.                     */
 /***************************************************************************/
 
-/**
- * \brief storage struct to keep values to send to CAN2
- */
-typedef struct
-{
-   //! wheel signal (as-is)
-   uint16_t wheelIn;
-   //! wheel signal (full 16bit)
-   uint16_t wheelOut;
-   //! engine RPM (as-is)
-   uint8_t rpm[2];
-   //! vehicle speed
-   uint8_t speed[2];
-   //! ignition key status (destination)
-   uint8_t ignition;
-   //! gear box status (destination)
-   uint8_t gearBox;
-   //! headlights status (destination) on/off
-   uint8_t headlights;
-   //! dimming of display (destination) 0..255
-   uint8_t dimLevel;
-   //! odometer value
-   uint8_t odo[3];
-   //! ambient temperature
-   uint8_t temp;
-} storeVals_t;
-
-//! temporary storage for any values comming via CAN
-storeVals_t storage;
+//! store written by decoders, see comm_store_beginUpdate()
+comm_store_t* storeUpdate;
+
+//! snapshot of store read by encoders, see comm_store_snapshot()
+comm_store_t storage;
+
+//! dimming of display (destination) 0..255, main loop only
+uint8_t dimLevel = 0;
 
 //! average of dimming values for CAN transmission
 uint16_t dimAverage  = 0x7F00;
@@ -72,85 +68,267 @@ bool isMetric    = true;
 //! language setup
 uint8_t language = LANG_GERMAN_CAN2;
 
-//! counts the seconds for any timing issue needed
-uint8_t countTicks = 0;
+/***************************************************************************/
+/* Signal tables                                                           */
+/***************************************************************************/
+
+//! default signals routed from CAN1 to CAN2, see comm_matrix.mtx
+const comm_signal_t comm_defaultSignals[] PROGMEM =
+{
+   COMM_MATRIX_SIGNALS
+};
+
+//! compilation fails, if the default signals do not fit into RAM
+typedef char comm_defaultSignalsFit[(ARRAY_SIZE(comm_defaultSignals) <=
+                                     COMM_MATRIX_MAX_SIGNALS) ? 1 : -1];
+
+//! signals in use, loaded from EEPROM or flash default
+comm_signal_t comm_signals[COMM_MATRIX_MAX_SIGNALS];
+
+//! information about signal matrix in use
+comm_matrix_info_t comm_matrixInfo;
 
 /***************************************************************************/
-/* fetch/fill functions for CAN (check IDs)                                */
+/* loading of signal matrix                                                */
 /***************************************************************************/
 
 /**
- * \brief fetch information from CAN1 and put to storage
- * \param msg - CAN message to extract
+ * \brief read the matrix from EEPROM into comm_signals
+ * \return true, if the matrix is complete and valid
+ *
+ * Ids of the signals are not checked against the dispatch lists, signals
+ * of ids not dispatched are simply never used.
  */
-void fetchInfoFromCAN1(can_t* msg)
+bool comm_matrix_loadEeprom(void)
 {
-   switch(msg->msgId)
+   comm_matrix_header_t header;
+   const uint8_t*       addr = (const uint8_t*)COMM_MATRIX_EEPROM_ADDR;
+   uint16_t             crc  = 0xFFFF;
+   uint8_t*             data;
+   uint16_t             size;
+   uint8_t              i;
+
+   eeprom_read_block(&header, addr, sizeof(header));
+
+   if((COMM_MATRIX_VERSION != header.version) ||
+      (0 == header.count) || (COMM_MATRIX_MAX_SIGNALS < header.count))
    {
-      case CANID_1_IGNITION:
-      {
-         transferIgnStatus(msg);
-         break;
-      }
+      return false;
+   }
 
-      case CANID_1_WHEEL_GEAR_DATA:
-      {
-         transferWheelGearTemp(msg);
-         break;
-      }
+   size = header.count * sizeof(comm_signal_t);
+   eeprom_read_block(comm_signals, addr + sizeof(header), size);
 
-      case CANID_1_TIME_AND_ODO:
-      {
-         uint8_t i;
-         uint8_t tmp = 0;
-         for(i = 0; i < 3; ++i)
-         {
-            // store odo value and change resolution from 1.0km to 0.1km
-            storage.odo[i] = (msg->data[i+1] << 1) | tmp;
-            // get MSB to put into LSB of next byte
-            if(i < 2)
-            {
-               tmp = (msg->data[i+1] & 0x80) >> 7;
-            }
-         }
-         break;
-      }
+   // CRC over header without crc itself and all signals
+   data = (uint8_t*)&header;
+   for(i = 0; i < offsetof(comm_matrix_header_t, crc); ++i)
+   {
+      crc = _crc16_update(crc, data[i]);
+   }
+   data = (uint8_t*)comm_signals;
+   while(0 != size--)
+   {
+      crc = _crc16_update(crc, *data++);
+   }
 
-      case CANID_1_RPM_STATUS:
-      {
-         // 0.25 rpm to 1.0 rpm
-         storage.rpm[0] = (msg->data[1] >> 2) | (msg->data[2] << 6);
-         storage.rpm[1] = msg->data[2] >> 2;
-         break;
-      }
+   if(crc != header.crc)
+   {
+      return false;
+   }
 
-      case CANID_1_COM_DISP_START:
-      case CANID_1_COM_CLUSTER_2_RADIO:
+   for(i = 0; i < header.count; ++i)
+   {
+      if(false == comm_signal_isValid(&comm_signals[i]))
       {
-         break;
+         return false;
       }
+   }
+
+   comm_matrixInfo.count    = header.count;
+   comm_matrixInfo.revision = header.revision;
+   return true;
+}
 
-      case CANID_1_PDC_STATUS:
+/**
+ * \brief load signal matrix from EEPROM or flash default
+ *
+ * The EEPROM matrix is used, if version, number of signals, CRC and all
+ * signal positions are valid. Otherwise the default of the flash is used.
+ * The time needed is measured by timebase_get(), so call after
+ * timebase_init().
+ *
+ * Only signals of ids with a dispatch entry take effect, see
+ * \ref matrix_eeprom_definitions.
+ */
+void comm_matrix_load(void)
+{
+   uint32_t start = timebase_get();
+   uint32_t time;
+
+   if(true == comm_matrix_loadEeprom())
+   {
+      comm_matrixInfo.source = COMM_MATRIX_EEPROM;
+   }
+   else
+   {
+      memcpy_P(comm_signals, comm_defaultSignals, sizeof(comm_defaultSignals));
+      comm_matrixInfo.source   = COMM_MATRIX_FLASH;
+      comm_matrixInfo.count    = ARRAY_SIZE(comm_defaultSignals);
+      comm_matrixInfo.revision = 0;
+   }
+
+   time = timebase_get() - start;
+   comm_matrixInfo.loadTime = (time > 0xFF) ? 0xFF : (uint8_t)time;
+}
+
+/**
+ * \brief get information about the signal matrix in use
+ * \return pointer to information
+ */
+comm_matrix_info_t* comm_matrix_getInfo(void)
+{
+   return &comm_matrixInfo;
+}
+
+/***************************************************************************/
+/* snapshot of slow signals over power off                                 */
+/***************************************************************************/
+
+/**
+ * \brief get the signal carrying the odometer to CAN2
+ * \return index of signal, comm_matrixInfo.count if there is none
+ */
+uint8_t comm_matrix_findOdometer(void)
+{
+   uint8_t i;
+
+   for(i = 0; i < comm_matrixInfo.count; ++i)
+   {
+      if(CANID_2_ODO_AND_TEMP == comm_signals[i].dstId)
       {
          break;
       }
+   }
+
+   return i;
+}
+
+/**
+ * \brief save the slow signals to EEPROM
+ *
+ * Odometer, dimming, language and units are kept in the snapshot ring
+ * (see comm_persist.h). Main loop only, e.g. before sleep.
+ */
+void comm_matrix_save(void)
+{
+   comm_persist_data_t data;
+   uint8_t             odometer = comm_matrix_findOdometer();
+
+   comm_store_snapshot(&storage);
+
+   data.revision   = comm_matrixInfo.revision;
+   data.odometer   = (odometer < comm_matrixInfo.count)
+                   ? storage.values[odometer] : 0;
+   data.dimAverage = dimAverage;
+   data.language   = language;
+   data.flags      = ((true == nightMode) ? COMM_PERSIST_NIGHT : 0) |
+                     ((true == isMetric) ? COMM_PERSIST_METRIC : 0);
+
+   comm_persist_save(&data);
+}
+
+/**
+ * \brief restore the slow signals from EEPROM
+ * \return true, if a valid snapshot was restored
+ *
+ * The odometer is restored only, if the signal matrix in use has the
+ * revision it was converted by. Call after comm_matrix_load() and before
+ * any decoding.
+ */
+bool comm_matrix_restore(void)
+{
+   comm_persist_data_t data;
+   uint8_t             odometer = comm_matrix_findOdometer();
+
+   if(false == comm_persist_load(&data))
+   {
+      return false;
+   }
+
+   if((odometer < comm_matrixInfo.count) &&
+      (data.revision == comm_matrixInfo.revision))
+   {
+      storeUpdate = comm_store_beginUpdate();
+      storeUpdate->values[odometer] = data.odometer;
+      comm_store_endUpdate();
+   }
+
+   dimAverage = data.dimAverage;
+   dimLevel   = dimAverage >> 8;
+   language   = data.language;
+   nightMode  = (0 != (data.flags & COMM_PERSIST_NIGHT));
+   isMetric   = (0 != (data.flags & COMM_PERSIST_METRIC));
+
+   return true;
+}
+
+
+/***************************************************************************/
+/* fetch/fill functions for CAN (check IDs)                                */
+/***************************************************************************/
+
+//! entry of CANID_1_CONSUMED as case of fetchInfoFromCAN1()
+#define COMM_FETCH_CAN1_CASE(id, function, mask)                     \
+   COMM_DISPATCH_CASE_DIRTY(id, function, mask, handler, dirty)
+
+/**
+ * \brief fetch information from CAN1 and put to storage
+ * \param msg - CAN message to extract
+ * \return false, if the message is not used by the matrix
+ */
+bool fetchInfoFromCAN1(can_t* msg)
+{
+   uint8_t        dirty   = 0;
+   comm_handler_t handler = 0;
 
+   PROFILE_BEGIN(PROFILE_FETCH_CAN1);
+   switch(msg->msgId)
+   {
+      CANID_1_CONSUMED(COMM_FETCH_CAN1_CASE)
       default:
-      {
-         // do nothing!
          break;
-      }
    }
+
+   if(0 == handler)
+   {
+      // not consumed, but passed the acceptance filters
+      PROFILE_END(PROFILE_FETCH_CAN1);
+      return false;
+   }
+
+   storeUpdate = comm_store_beginUpdate();
+   handler(msg);
+   comm_store_endUpdate();
+
+   // CAN2 messages depending on this one, see comm_tx_run()
+   comm_tx_markDirty(dirty);
+#ifdef PROFILE_ENABLE
+   comm_timing_received(dirty);
+#endif
+   PROFILE_END(PROFILE_FETCH_CAN1);
+   return true;
 }
 
 /**
  * \brief fetch information from CAN2 and put to storage
  * \param msg - CAN message to extract
+ * \return false, if the message is not used by the matrix
  *
  * \todo get text and media information from CAN2
  */
-void fetchInfoFromCAN2(can_t* msg)
+bool fetchInfoFromCAN2(can_t* msg)
 {
+   return false;
 }
 
 /**
@@ -161,15 +339,27 @@ void fillInfoToCAN1(can_t* msg)
 {
 }
 
+//! entry of CANID_2_PRODUCED as case of fillInfoToCAN2()
+#define COMM_FILL_CAN2_CASE(id, function, mask)                      \
+   COMM_DISPATCH_CASE(id, function, handler)
+
 /**
  * \brief put information from storage to CAN2
  * \param msg - CAN message to fill
  *
- * \todo add values of temperature
+ * Called on a cache miss of comm_tx_run() only.
  */
 void fillInfoToCAN2(can_t* msg)
 {
-   uint8_t dimOffset = (nightMode) ? NIGHT_OFFSET : 0;
+   comm_handler_t handler = 0;
+
+   PROFILE_BEGIN(PROFILE_FILL_CAN2);
+   switch(msg->msgId)
+   {
+      CANID_2_PRODUCED(COMM_FILL_CAN2_CASE)
+      default:
+         break;
+   }
 
    // remove any old values
    for(int i = 0; i < 8; ++i)
@@ -177,99 +367,13 @@ void fillInfoToCAN2(can_t* msg)
       msg->data[i] = 0;
    }
 
-   switch(msg->msgId)
+   if(0 != handler)
    {
-      case CANID_2_IGNITION:
-      {
-         // fill in length of message
-         msg->header.len = 2;
-         // main ignition status
-         msg->data[0] = storage.ignition;
-         // 0: start not active; 1: normal start
-         msg->data[1] = (storage.ignition & 0x80) ? 1 : 0;
-         break;
-      }
-
-      case CANID_2_WHEEL_DATA:
-      {
-         // message is 8 bytes long
-         msg->header.len = 8;
-         // byte 0/1: engine PRM
-         msg->data[0] = storage.rpm[1];
-         msg->data[1] = storage.rpm[0];
-         // byte 2/3: vehicle speed
-         msg->data[2] = storage.speed[1];
-         msg->data[3] = storage.speed[0];
-         // byte 4/5: wheel count left
-         msg->data[4] = storage.wheelOut >> 8;
-         msg->data[5] = (storage.wheelOut & 0xFF);
-         // byte 6/7: wheel count right
-         msg->data[6] = storage.wheelOut >> 8;
-         msg->data[7] = (storage.wheelOut & 0xFF);
-         break;
-      }
-
-      case CANID_2_REVERSE_GEAR:
-      {
-         // message is 7 bytes long
-         msg->header.len = 7;
-         // gear box status
-         msg->data[2] = storage.gearBox;
-         break;
-      }
-
-      case CANID_2_DIMMING:
-      {
-         // message is 3 bytes long
-         msg->header.len = 3;
-         // byte 1 bit 0 - day/night switch
-         nightMode    = ((false == nightMode) &&
-                         (storage.dimLevel < DAY_NIGHT_LOWER_LIMIT)) ||
-                        ((true == nightMode) &&
-                         (storage.dimLevel < DAY_NIGHT_UPPER_LIMIT));
-         msg->data[0] = (nightMode) ? DIM_2_DAY_MODE : DIM_2_NIGHT_MODE;
-         msg->data[1] = storage.dimLevel + dimOffset; // radio
-         msg->data[2] = storage.dimLevel + dimOffset; // interior
-         break;
-      }
-
-      case CANID_2_ODO_AND_TEMP:
-      {
-         uint8_t i;
-         // message is 7 bytes long
-         msg->header.len = 7;
-         for(i = 0; i < 3; ++i)
-         {
-            msg->data[i] = storage.odo[i];
-         }
-         // temperature needs to be stored here
-         //msg->data[4] = storage.temp;
-         //msg->data[5] = storage.temp;
-         break;
-      }
-
-      case CANID_2_LANGUAGE_AND_UNIT:
-      {  // 1000ms cycle
-         msg->header.len = 4;
-         msg->data[0]  = (true == isMetric) ? 0x01 : 0x00;
-         msg->data[0] |= (language << 4);
-         break;
-      }
-
-      case CANID_2_VEH_CONFIG:
-      {  // 2000ms cycle
-         msg->header.len = 8;
-         msg->data[0] = CONFIG_STATUS_PROGRAMMED;
-         msg->data[2] = VEH_BRAND_VW << 3;
-         break;
-      }
-
-      default:
-      {
-         // do nothing!
-         break;
-      }
+      // consistent values, even if decoded meanwhile
+      comm_store_snapshot(&storage);
+      handler(msg);
    }
+   PROFILE_END(PROFILE_FILL_CAN2);
 }
 
 
@@ -286,8 +390,9 @@ void fillInfoToCAN2(can_t* msg)
  */
 void transferIgnStatus(can_t* msg)
 {
-   uint8_t status = 0;
-   uint8_t byte0  = msg->data[0];
+   uint8_t          status = 0;
+   uint8_t          byte0  = msg->data[0];
+   comm_sleep_ign_t state  = COMM_SLEEP_IGN_OFF;
 
    // Note: Byte2 (start status) is set to SNA (7) or normal start (1) when
    //       sending destination message.
@@ -298,6 +403,7 @@ void transferIgnStatus(can_t* msg)
       // bit  0   - Key In Ignition
       // bit 5-7 - IGN on
       status = (IGN_2_ON | IGN_2_KeyIn);
+      state  = COMM_SLEEP_IGN_ON;
    }
    // check Key In/ACC status
    else if(byte0 & IGN_1_ACC_Status)
@@ -305,10 +411,13 @@ void transferIgnStatus(can_t* msg)
       // bit  0   - Key In Ignition
       // bits 5-7 - IGN off and ACC on
       status = (IGN_2_ACC_On_IGN_Off | IGN_2_KeyIn);
+      state  = COMM_SLEEP_IGN_ACC;
    }
 
    // store information
-   storage.ignition = status;
+   storeUpdate->ignition = status;
+   // quiet time until bus sleep depends on it
+   comm_sleep_setIgnition(state);
 }
 
 /**
@@ -322,135 +431,230 @@ void transferIgnStatus(can_t* msg)
  */
 void transferWheelGearTemp(can_t* msg)
 {
-   uint16_t wheelTmp = storage.wheelIn;
+   uint16_t wheelTmp = storeUpdate->wheelIn;
    uint16_t wheelDelta = 0;
 
-   // store information: bit 1: 1 - reverse; 0 - not reverse (assume D(rive))
-   storage.gearBox = (msg->data[0] & 0x02) ? 0x01 : 0x04;
-   // store speed information: CAN1 uses approx. half of the resolution of
-   // CAN2 speed signal.
-   storage.speed[0] = (msg->data[1] >> 1) | ((msg->data[2] & 0x01) << 7);
-   storage.speed[1] = msg->data[2] >> 1;
+   // store information: 1 - reverse; 0 - not reverse (assume D(rive))
+   storeUpdate->gearBox = COMM_CODEC_GET(msg->data,
+                                    COMM_SIG_1_WHEEL_GEAR_DATA_REVERSE) ? 0x01
+                                                                        : 0x04;
+   // store speed information, see comm_signals
+   transferSignals(msg);
    // only 11 bits per wheel for count value
    // store new wheel signal first, old one saved in tmp
-   storage.wheelIn   = (msg->data[4] & 0x07);
-   storage.wheelIn <<= 8;
-   storage.wheelIn  |= msg->data[3];
+   storeUpdate->wheelIn = COMM_CODEC_GET(msg->data,
+                                    COMM_SIG_1_WHEEL_GEAR_DATA_WHEEL_COUNT);
    // get difference
-   wheelDelta = storage.wheelIn - wheelTmp;
+   wheelDelta = storeUpdate->wheelIn - wheelTmp;
    // check overflow
-   if (wheelTmp > storage.wheelIn)
+   if (wheelTmp > storeUpdate->wheelIn)
    {
       // get correct difference including turnaround
       wheelDelta = 2047 - wheelTmp;
-      wheelDelta += storage.wheelIn;
+      wheelDelta += storeUpdate->wheelIn;
    }
    // add to destination counter
-   storage.wheelOut += wheelDelta;
+   storeUpdate->wheelOut += wheelDelta;
    // store temperature too
-   storage.temp = msg->data[5];
+   storeUpdate->temp = COMM_CODEC_GET(msg->data,
+                                 COMM_SIG_1_WHEEL_GEAR_DATA_TEMP_OUTSIDE);
+}
+
+/**
+ * \brief transfer all signals of a message to storage
+ *
+ * Direction from CAN1 to CAN2
+ *
+ * \param msg - pointer to CAN message
+ * \sa comm_signals
+ */
+void transferSignals(can_t* msg)
+{
+   comm_signal_decode(comm_signals, comm_matrixInfo.count,
+                      storeUpdate->values, msg);
 }
 
+/**
+ * \brief consume a message without evaluating it (yet)
+ *
+ * Used for the instrument cluster communication and PDC status.
+ *
+ * \param msg - pointer to CAN message
+ */
+void transferNothing(can_t* msg)
+{
+}
 
 /***************************************************************************/
-/* Helpers to be called by main routine                                    */
+/* Encoders of CAN2 messages                                               */
 /***************************************************************************/
 
 /**
- * \brief send CAN1 messages
- * \param msg - pointer to message struct
+ * \brief fill all signals of a message from storage
+ * \param msg - CAN message to fill
+ * \sa comm_signals
  */
-void sendCan1(can_t* msg)
+void fillSignals(can_t* msg)
 {
+   comm_signal_encode(comm_signals, comm_matrixInfo.count,
+                      storage.values, msg);
 }
 
 /**
- * \brief sends message to CAN1 and filling up converted data
- *
- * \note Set message id before calling this function.
- *
- * \param msg - pointer to CAN message with set msg id
+ * \brief fill ignition status
+ * \param msg - CAN message to fill
  */
-void sendCan1Message(can_t* msg)
+void fillIgnStatus(can_t* msg)
 {
-   fillInfoToCAN1(msg);
+   // fill in length of message
+   msg->header.len = COMM_DLC_2_IGNITION;
+   // main ignition status
+   COMM_CODEC_SET(msg->data, COMM_SIG_2_IGNITION_STATUS, storage.ignition);
+   // 0: start not active; 1: normal start
+   COMM_CODEC_SET(msg->data, COMM_SIG_2_IGNITION_START,
+                  (storage.ignition & 0x80) ? 1 : 0);
+}
 
-   while(0 == can_send_message(CAN_CHIP1, msg))
-   {
-      // wait for empty send buffer
-      _delay_us(10);
-   }
+/**
+ * \brief fill gear box status
+ * \param msg - CAN message to fill
+ */
+void fillReverseGear(can_t* msg)
+{
+   msg->header.len = COMM_DLC_2_REVERSE_GEAR;
+   // gear box status
+   COMM_CODEC_SET(msg->data, COMM_SIG_2_REVERSE_GEAR_GEAR, storage.gearBox);
 }
 
+/**
+ * \brief fill engine RPM, speed and wheel counts
+ * \param msg - CAN message to fill
+ */
+void fillWheelData(can_t* msg)
+{
+   msg->header.len = COMM_DLC_2_WHEEL_DATA;
+   // byte 0/1: engine RPM; byte 2/3: vehicle speed
+   fillSignals(msg);
+   // byte 4/5: wheel count left; byte 6/7: wheel count right
+   COMM_CODEC_SET(msg->data, COMM_SIG_2_WHEEL_DATA_WHEEL_LEFT,
+                  storage.wheelOut);
+   COMM_CODEC_SET(msg->data, COMM_SIG_2_WHEEL_DATA_WHEEL_RIGHT,
+                  storage.wheelOut);
+}
 
 /**
- * \brief send CAN2 messages
- * \param msg - pointer to message struct
+ * \brief fill odometer and temperature
+ * \param msg - CAN message to fill
+ *
+ * \todo add values of temperature
  */
-void sendCan2(can_t* msg)
+void fillOdoAndTemp(can_t* msg)
 {
-   // 50ms
-   ++countTicks;
+   msg->header.len = COMM_DLC_2_ODO_AND_TEMP;
+   // byte 0..2: odometer
+   fillSignals(msg);
+   // temperature needs to be stored here
+   //msg->data[4] = storage.temp;
+   //msg->data[5] = storage.temp;
+}
 
-   // 100ms
-   if(0 == (countTicks % 2))
-   {
-      msg->msgId = CANID_2_IGNITION;
-      sendCan2Message(msg);
+/**
+ * \brief fill language and units (1000ms cycle)
+ * \param msg - CAN message to fill
+ */
+void fillLanguageAndUnit(can_t* msg)
+{
+   msg->header.len = COMM_DLC_2_LANGUAGE_AND_UNIT;
+   COMM_CODEC_SET(msg->data, COMM_SIG_2_LANGUAGE_AND_UNIT_METRIC,
+                  (true == isMetric) ? 1 : 0);
+   COMM_CODEC_SET(msg->data, COMM_SIG_2_LANGUAGE_AND_UNIT_LANGUAGE, language);
+}
 
-      msg->msgId = CANID_2_WHEEL_DATA;  // should be 50ms, but keep it
-      sendCan2Message(msg);
+/**
+ * \brief fill vehicle configuration (2000ms cycle)
+ * \param msg - CAN message to fill
+ */
+void fillVehConfig(can_t* msg)
+{
+   msg->header.len = COMM_DLC_2_VEH_CONFIG;
+   COMM_CODEC_SET(msg->data, COMM_SIG_2_VEH_CONFIG_STATUS,
+                  CONFIG_STATUS_PROGRAMMED);
+   COMM_CODEC_SET(msg->data, COMM_SIG_2_VEH_CONFIG_BRAND, VEH_BRAND_VW);
+}
 
-      msg->msgId = CANID_2_ODO_AND_TEMP;
-      sendCan2Message(msg);
-   }
+/**
+ * \brief fill dimming and day/night mode
+ * \param msg - CAN message to fill
+ */
+void fillDimming(can_t* msg)
+{
+   uint8_t dimOffset;
+
+   msg->header.len = COMM_DLC_2_DIMMING;
+   // byte 1 bit 0 - day/night switch
+   nightMode    = ((false == nightMode) &&
+                   (dimLevel < DAY_NIGHT_LOWER_LIMIT)) ||
+                  ((true == nightMode) &&
+                   (dimLevel < DAY_NIGHT_UPPER_LIMIT));
+   // offset of the mode sent, the frame is cached until dimLevel changes
+   dimOffset    = (nightMode) ? NIGHT_OFFSET : 0;
+   COMM_CODEC_SET(msg->data, COMM_SIG_2_DIMMING_DAY_NIGHT,
+                  (nightMode) ? DIM_2_DAY_MODE : DIM_2_NIGHT_MODE);
+   COMM_CODEC_SET(msg->data, COMM_SIG_2_DIMMING_DISPLAY,         // radio
+                  dimLevel + dimOffset);
+   COMM_CODEC_SET(msg->data, COMM_SIG_2_DIMMING_INTERIOR,        // interior
+                  dimLevel + dimOffset);
+}
 
-   // 500ms
-   if(0 == (countTicks % 10))
-   {
-      msg->msgId = CANID_2_DIMMING;
-      sendCan2Message(msg);
 
-      msg->msgId = CANID_2_REVERSE_GEAR;
-      sendCan2Message(msg);
-   }
+/***************************************************************************/
+/* Helpers to be called by main routine                                    */
+/***************************************************************************/
 
-   // 1000ms
-   if(0 == (countTicks % 20))
-   {
-      msg->msgId = CANID_2_LANGUAGE_AND_UNIT;
-      sendCan2Message(msg);
-   }
+/**
+ * \brief send CAN1 messages
+ * \param msg - pointer to message struct
+ */
+void sendCan1(can_t* msg)
+{
+}
 
-   // 2000ms
-   if(0 == (countTicks % 40))
-   {
-      msg->msgId = CANID_2_VEH_CONFIG;
-      sendCan2Message(msg);
-   }
+/**
+ * \brief sends message to CAN1 and filling up converted data
+ *
+ * \note Set message id before calling this function.
+ *
+ * \param msg - pointer to CAN message with set msg id
+ * \param prio - importance of message
+ * \param lifetime - time to send the message, e.g. its cycle time
+ */
+void sendCan1Message(can_t* msg, can_tx_prio_t prio, uint16_t lifetime)
+{
+   fillInfoToCAN1(msg);
+
+   can_tx_send(CAN_CHIP1, msg, prio, CAN_TX_CYCLIC, lifetime);
 }
 
+
 /**
  * \brief sends message to CAN2 and filling up converted data
  *
  * \note Set message id before calling this function.
  *
  * \param msg - pointer to CAN message with set msg id
+ * \param prio - importance of message
+ * \param lifetime - time to send the message, e.g. its cycle time
  */
-void sendCan2Message(can_t* msg)
+void sendCan2Message(can_t* msg, can_tx_prio_t prio, uint16_t lifetime)
 {
    fillInfoToCAN2(msg);
 
-   while(0 == can_send_message(CAN_CHIP2, msg))
-   {
-      // wait for empty send buffer
-      _delay_us(10);
-   }
+   can_tx_send(CAN_CHIP2, msg, prio, CAN_TX_CYCLIC, lifetime);
 }
 
 /**
  * \brief gets a dim value to be sent via CAN
- * \param value - dim value 0..65535 (left aligned from ADC)
+ * \param value - dim value 0..65535 (left aligned, oversampled ADC)
  *
  * This function uses an integral to get an averaged value to set
  * the dimlevel of the target unit (CAN). Since nobody wants to have
@@ -463,16 +667,25 @@ void sendCan2Message(can_t* msg)
  */
 void setDimValue(uint16_t value)
 {
+   PROFILE_BEGIN(PROFILE_SET_DIM);
+
    // integral for averaging dim values
    dimAverage = value/DIM_STEPS_2_AVERAGE + dimAverage - dimAverage/DIM_STEPS_2_AVERAGE;
 
-   // set dim level for upper 8bit of 10bit left aligned average value
+   // set dim level for upper 8bit of 12bit left aligned average value
+   // (10bit ADC + ADC_SAMPLE_EXTRA_BITS, see adc_sample.h)
    //
-   // | 0 | 0 | 0 | 0 | 0 | 0 | 0 | 0 | 0 | 0 | x | x | x | x | x | x |
-   // | 9 | 8 | 7 | 6 | 5 | 4 | 3 | 2 | 1 | 0 | x | x | x | x | x | x |
+   // | 1 | 1 | 0 | 0 | 0 | 0 | 0 | 0 | 0 | 0 | 0 | 0 | x | x | x | x |
+   // | 1 | 0 | 9 | 8 | 7 | 6 | 5 | 4 | 3 | 2 | 1 | 0 | x | x | x | x |
    // |          upper byte           |          lower byte           |
-   // |                 value                 |       not used        |
+   // |                     value                     |   not used    |
    // |        dimming average        |           discarded           |
-   storage.dimLevel = dimAverage >> 8;
+   if((dimAverage >> 8) != dimLevel)
+   {
+      dimLevel = dimAverage >> 8;
+      comm_tx_markDirty(COMM_TX_BIT_2_DIMMING);
+   }
+
+   PROFILE_END(PROFILE_SET_DIM);
 }
 
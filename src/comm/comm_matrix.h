@@ -87,25 +87,160 @@
  */
 #define MEDIA_INFO_MESSAGE_LENGTH      8
 
+/**
+ * \def ARRAY_SIZE
+ * \brief number of elements of an array (not of a pointer)
+ */
+#define ARRAY_SIZE(array)              (sizeof(array) / sizeof(array[0]))
+
 /*! @} */
 
+/**
+ * \addtogroup matrix_eeprom_definitions EEPROM Resident Signal Matrix
+ * \brief Definitions for loading the signal matrix from EEPROM
+ *
+ * EEPROM layout at COMM_MATRIX_EEPROM_ADDR (little endian, packed):
+ * \code
+ * byte 0    : version (COMM_MATRIX_VERSION)
+ * byte 1    : number of signals (1..COMM_MATRIX_MAX_SIGNALS)
+ * byte 2..3 : revision of matrix content, e.g. per vehicle
+ * byte 4..5 : CRC16 of bytes 0..3 and all signals (_crc16_update(), 0xFFFF)
+ * byte 6..  : signals, 14 bytes each (see comm_signal_t)
+ * \endcode
+ *
+ * The snapshot ring of the slow signals follows at COMM_PERSIST_EEPROM_ADDR
+ * (see comm_persist.h).
+ *
+ * The EEPROM matrix only remaps signals among messages the firmware
+ * already handles: a signal is decoded, if its source id is dispatched to
+ * transferSignals() (CANID_1_CONSUMED), and encoded, if its destination id
+ * is sent by an encoder calling fillSignals() (CANID_2_PRODUCED). Ids not
+ * dispatched also do not pass the acceptance filters. Signals of other ids
+ * are loaded and checked, but never used - new ids need a new firmware.
+ * @{
+ */
+
+/**
+ * \def COMM_MATRIX_VERSION
+ * \brief version of the EEPROM layout
+ */
+#define COMM_MATRIX_VERSION            1
+
+/**
+ * \def COMM_MATRIX_MAX_SIGNALS
+ * \brief maximum number of signals kept in RAM (14 + 4 bytes each)
+ */
+#define COMM_MATRIX_MAX_SIGNALS        8
+
+/**
+ * \def COMM_MATRIX_EEPROM_ADDR
+ * \brief start address of the matrix in EEPROM
+ */
+#define COMM_MATRIX_EEPROM_ADDR        0x0000
+
+/*! @} */
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief header of the matrix in EEPROM
+ */
+typedef struct
+{
+   //! version of the layout
+   uint8_t  version;
+   //! number of signals following
+   uint8_t  count;
+   //! revision of matrix content
+   uint16_t revision;
+   //! CRC16 of header (without crc) and signals
+   uint16_t crc;
+} comm_matrix_header_t;
+
+/**
+ * \brief origin of the signal matrix in use
+ */
+typedef enum
+{
+   //! default matrix compiled into flash
+   COMM_MATRIX_FLASH   = 0,
+   //! matrix loaded from EEPROM
+   COMM_MATRIX_EEPROM  = 1
+} comm_matrix_source_t;
+
+/**
+ * \brief information about the signal matrix in use
+ */
+typedef struct
+{
+   //! origin of matrix
+   comm_matrix_source_t source;
+   //! number of signals
+   uint8_t              count;
+   //! revision of matrix content (0 for flash default)
+   uint16_t             revision;
+   //! time to load (and check) the matrix in 16us units (0xFF - overflow)
+   uint8_t              loadTime;
+} comm_matrix_info_t;
+
 
 
 /***************************************************************************/
 /* functions for matrix operations                                         */
 /***************************************************************************/
 
+/**
+ * \brief load signal matrix from EEPROM or flash default
+ *
+ * The EEPROM matrix is used, if version, number of signals, CRC and all
+ * signal positions are valid. Otherwise the default of the flash is used.
+ * The time needed is measured by timebase_get(), so call after
+ * timebase_init().
+ *
+ * Only signals of ids with a dispatch entry take effect, see
+ * \ref matrix_eeprom_definitions.
+ */
+void comm_matrix_load(void);
+
+/**
+ * \brief get information about the signal matrix in use
+ * \return pointer to information
+ */
+comm_matrix_info_t* comm_matrix_getInfo(void);
+
+/**
+ * \brief save the slow signals to EEPROM
+ *
+ * Odometer, dimming, language and units are kept in the snapshot ring
+ * (see comm_persist.h). Main loop only, e.g. before sleep.
+ */
+void comm_matrix_save(void);
+
+/**
+ * \brief restore the slow signals from EEPROM
+ * \return true, if a valid snapshot was restored
+ *
+ * The odometer is restored only, if the signal matrix in use has the
+ * revision it was converted by. Call after comm_matrix_load() and before
+ * any decoding.
+ */
+bool comm_matrix_restore(void);
+
 /**
  * \brief fetch information from CAN1 and put to storage
  * \param msg - CAN message to extract
+ * \return false, if the message is not used by the matrix
  */
-void fetchInfoFromCAN1(can_t* msg);
+bool fetchInfoFromCAN1(can_t* msg);
 
 /**
  * \brief fetch information from CAN2 and put to storage
  * \param msg - CAN message to extract
+ * \return false, if the message is not used by the matrix
  */
-void fetchInfoFromCAN2(can_t* msg);
+bool fetchInfoFromCAN2(can_t* msg);
 
 /**
  * \brief put information from storage to CAN1
@@ -116,6 +251,8 @@ void fillInfoToCAN1(can_t* msg);
 /**
  * \brief put information from storage to CAN2
  * \param msg - CAN message to fill
+ *
+ * Called on a cache miss of comm_tx_run() only.
  */
 void fillInfoToCAN2(can_t* msg);
 
@@ -144,6 +281,76 @@ void transferIgnStatus(can_t* msg);
  */
 void transferWheelGearTemp(can_t* msg);
 
+/**
+ * \brief transfer all signals of a message to storage
+ *
+ * Direction from CAN1 to CAN2
+ *
+ * \param msg - pointer to CAN message
+ * \sa comm_signals
+ */
+void transferSignals(can_t* msg);
+
+/**
+ * \brief consume a message without evaluating it (yet)
+ *
+ * Used for the instrument cluster communication and PDC status.
+ *
+ * \param msg - pointer to CAN message
+ */
+void transferNothing(can_t* msg);
+
+/**
+ * \brief fill all signals of a message from storage
+ * \param msg - CAN message to fill
+ * \sa comm_signals
+ */
+void fillSignals(can_t* msg);
+
+/**
+ * \brief fill ignition status
+ * \param msg - CAN message to fill
+ */
+void fillIgnStatus(can_t* msg);
+
+/**
+ * \brief fill gear box status
+ * \param msg - CAN message to fill
+ */
+void fillReverseGear(can_t* msg);
+
+/**
+ * \brief fill engine RPM, speed and wheel counts
+ * \param msg - CAN message to fill
+ */
+void fillWheelData(can_t* msg);
+
+/**
+ * \brief fill odometer and temperature
+ * \param msg - CAN message to fill
+ *
+ * \todo add values of temperature
+ */
+void fillOdoAndTemp(can_t* msg);
+
+/**
+ * \brief fill language and units (1000ms cycle)
+ * \param msg - CAN message to fill
+ */
+void fillLanguageAndUnit(can_t* msg);
+
+/**
+ * \brief fill vehicle configuration (2000ms cycle)
+ * \param msg - CAN message to fill
+ */
+void fillVehConfig(can_t* msg);
+
+/**
+ * \brief fill dimming and day/night mode
+ * \param msg - CAN message to fill
+ */
+void fillDimming(can_t* msg);
+
 
 /***************************************************************************/
 /* Helpers to be called by main routine                                    */
@@ -161,14 +368,10 @@ void sendCan1(can_t* msg);
  * \note Set message id before calling this function.
  *
  * \param msg - pointer to CAN message with set msg id
+ * \param prio - importance of message
+ * \param lifetime - time to send the message, e.g. its cycle time
  */
-void sendCan1Message(can_t* msg);
-
-/**
- * \brief send CAN2 messages
- * \param msg - pointer to message struct
- */
-void sendCan2(can_t* msg);
+void sendCan1Message(can_t* msg, can_tx_prio_t prio, uint16_t lifetime);
 
 /**
  * \brief sends message to CAN2 and filling up converted data
@@ -176,12 +379,14 @@ void sendCan2(can_t* msg);
  * \note Set message id before calling this function.
  *
  * \param msg - pointer to CAN message with set msg id
+ * \param prio - importance of message
+ * \param lifetime - time to send the message, e.g. its cycle time
  */
-void sendCan2Message(can_t* msg);
+void sendCan2Message(can_t* msg, can_tx_prio_t prio, uint16_t lifetime);
 
 /**
  * \brief gets a dim value to be sent via CAN
- * \param value - dim value 0..65535 (left aligned from ADC)
+ * \param value - dim value 0..65535 (left aligned, oversampled ADC)
  *
  * This function uses an integral to get an averaged value to set
  * the dimlevel of the target unit (CAN). Since nobody wants to have
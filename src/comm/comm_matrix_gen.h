@@ -0,0 +1,208 @@
+/**
+ * \file comm_matrix_gen.h
+ *
+ * Generated by tools/matrix_compiler from comm_matrix.mtx - do not edit!
+ **/
+
+#ifndef COMM_MATRIX_GEN_H_
+#define COMM_MATRIX_GEN_H_
+
+#include "comm_can_ids.h"
+
+/**
+ * \addtogroup matrix_can_ids_registry CAN IDs Handled by The Matrix
+ * \brief CAN ids received or sent together with their handlers
+ *
+ * Each list entry is X(id, handler, dirty). The lists are expanded into
+ * the cases of the dispatch switches of comm_matrix.c and are sorted by
+ * ascending id for readability. dirty is the mask of sent messages
+ * depending on a consumed one (see comm_tx_markDirty()) or the bit of a
+ * produced message. The acceptance masks and filters in
+ * can_io/can_filter_config.h are generated from the same messages by
+ * tools/matrix_compiler. The ids are the ones of comm_can_ids.h, the
+ * matrix compiler checks its description against them.
+ *
+ * @{
+ */
+
+/**
+ * \def CANID_1_CONSUMED
+ * \brief CAN ids evaluated on CAN #1 and their decoders
+ *
+ * \def CANID_1_PRODUCED
+ * \brief CAN ids sent on CAN #1 and their encoders
+ *
+ * \def CANID_1_WAKE
+ * \brief consumed CAN ids waking the gateway on CAN #1
+ */
+#define CANID_1_CONSUMED(X)                                         \
+   X(CANID_1_IGNITION,             transferIgnStatus,      0x01)    \
+   X(CANID_1_COM_DISP_START,       transferNothing,        0x00)    \
+   X(CANID_1_WHEEL_GEAR_DATA,      transferWheelGearTemp,  0x06)    \
+   X(CANID_1_RPM_STATUS,           transferSignals,        0x04)    \
+   X(CANID_1_PDC_STATUS,           transferNothing,        0x00)    \
+   X(CANID_1_TIME_AND_ODO,         transferSignals,        0x08)    \
+   X(CANID_1_COM_CLUSTER_2_RADIO,  transferNothing,        0x00)
+#define CANID_1_PRODUCED(X)
+#define CANID_1_WAKE(X)                                             \
+   X(CANID_1_IGNITION,             transferIgnStatus,      0x01)
+
+/**
+ * \def CANID_2_CONSUMED
+ * \brief CAN ids evaluated on CAN #2 and their decoders
+ *
+ * \def CANID_2_PRODUCED
+ * \brief CAN ids sent on CAN #2 and their encoders
+ *
+ * \def CANID_2_WAKE
+ * \brief consumed CAN ids waking the gateway on CAN #2
+ */
+#define CANID_2_CONSUMED(X)
+#define CANID_2_PRODUCED(X)                                         \
+   X(CANID_2_IGNITION,             fillIgnStatus,          0x01)    \
+   X(CANID_2_REVERSE_GEAR,         fillReverseGear,        0x02)    \
+   X(CANID_2_WHEEL_DATA,           fillWheelData,          0x04)    \
+   X(CANID_2_ODO_AND_TEMP,         fillOdoAndTemp,         0x08)    \
+   X(CANID_2_LANGUAGE_AND_UNIT,    fillLanguageAndUnit,    0x10)    \
+   X(CANID_2_VEH_CONFIG,           fillVehConfig,          0x20)    \
+   X(CANID_2_DIMMING,              fillDimming,            0x40)
+#define CANID_2_WAKE(X)
+
+/*! @} */
+
+/**
+ * \addtogroup matrix_signals Signals of The Matrix
+ * \brief data length of messages and position of their signals
+ *
+ * A signal is described as start, length, order, dlc for use with
+ * COMM_CODEC_GET() and COMM_CODEC_SET() of comm_codec.h.
+ *
+ * @{
+ */
+
+#define COMM_DLC_1_IGNITION                            2
+#define COMM_SIG_1_IGNITION_ACC_KEY_IN                 0, 1, COMM_SIGNAL_INTEL, COMM_DLC_1_IGNITION
+#define COMM_SIG_1_IGNITION_TERMINAL_15                1, 1, COMM_SIGNAL_INTEL, COMM_DLC_1_IGNITION
+#define COMM_SIG_1_IGNITION_TERMINAL_X                 2, 1, COMM_SIGNAL_INTEL, COMM_DLC_1_IGNITION
+#define COMM_SIG_1_IGNITION_TERMINAL_50                3, 1, COMM_SIGNAL_INTEL, COMM_DLC_1_IGNITION
+#define COMM_SIG_1_IGNITION_ENGINE_RUNS                7, 1, COMM_SIGNAL_INTEL, COMM_DLC_1_IGNITION
+#define COMM_SIG_1_IGNITION_DIAG_ERROR                 15, 1, COMM_SIGNAL_INTEL, COMM_DLC_1_IGNITION
+
+#define COMM_DLC_1_COM_DISP_START                      8
+
+#define COMM_DLC_1_WHEEL_GEAR_DATA                     8
+#define COMM_SIG_1_WHEEL_GEAR_DATA_REVERSE             1, 1, COMM_SIGNAL_INTEL, COMM_DLC_1_WHEEL_GEAR_DATA
+#define COMM_SIG_1_WHEEL_GEAR_DATA_SPEED_SOURCE        8, 1, COMM_SIGNAL_INTEL, COMM_DLC_1_WHEEL_GEAR_DATA
+#define COMM_SIG_1_WHEEL_GEAR_DATA_SPEED               9, 15, COMM_SIGNAL_INTEL, COMM_DLC_1_WHEEL_GEAR_DATA /* (0.01,0) km/h */
+#define COMM_SIG_1_WHEEL_GEAR_DATA_WHEEL_COUNT         24, 11, COMM_SIGNAL_INTEL, COMM_DLC_1_WHEEL_GEAR_DATA
+#define COMM_SIG_1_WHEEL_GEAR_DATA_WHEEL_OVERRUN       35, 1, COMM_SIGNAL_INTEL, COMM_DLC_1_WHEEL_GEAR_DATA
+#define COMM_SIG_1_WHEEL_GEAR_DATA_ABS_ACTIVE          36, 1, COMM_SIGNAL_INTEL, COMM_DLC_1_WHEEL_GEAR_DATA
+#define COMM_SIG_1_WHEEL_GEAR_DATA_TEMP_OUTSIDE        40, 8, COMM_SIGNAL_INTEL, COMM_DLC_1_WHEEL_GEAR_DATA /* (0.5,-50.5) degC */
+
+#define COMM_DLC_1_RPM_STATUS                          8
+#define COMM_SIG_1_RPM_STATUS_RPM                      8, 16, COMM_SIGNAL_INTEL, COMM_DLC_1_RPM_STATUS /* (0.25,0) rpm */
+#define COMM_SIG_1_RPM_STATUS_ENGINE_TEMP              24, 8, COMM_SIGNAL_INTEL, COMM_DLC_1_RPM_STATUS
+#define COMM_SIG_1_RPM_STATUS_FAN_STATUS               40, 8, COMM_SIGNAL_INTEL, COMM_DLC_1_RPM_STATUS /* (1,0) % */
+
+#define COMM_DLC_1_PDC_STATUS                          8
+#define COMM_SIG_1_PDC_STATUS_FRONT_LEFT               0, 8, COMM_SIGNAL_INTEL, COMM_DLC_1_PDC_STATUS /* (1,0) cm */
+#define COMM_SIG_1_PDC_STATUS_FRONT_RIGHT              8, 8, COMM_SIGNAL_INTEL, COMM_DLC_1_PDC_STATUS /* (1,0) cm */
+#define COMM_SIG_1_PDC_STATUS_REAR_LEFT                16, 8, COMM_SIGNAL_INTEL, COMM_DLC_1_PDC_STATUS /* (1,0) cm */
+#define COMM_SIG_1_PDC_STATUS_REAR_RIGHT               24, 8, COMM_SIGNAL_INTEL, COMM_DLC_1_PDC_STATUS /* (1,0) cm */
+#define COMM_SIG_1_PDC_STATUS_FRONT_MID_LEFT           32, 8, COMM_SIGNAL_INTEL, COMM_DLC_1_PDC_STATUS /* (1,0) cm */
+#define COMM_SIG_1_PDC_STATUS_FRONT_MID_RIGHT          40, 8, COMM_SIGNAL_INTEL, COMM_DLC_1_PDC_STATUS /* (1,0) cm */
+#define COMM_SIG_1_PDC_STATUS_REAR_MID_LEFT            48, 8, COMM_SIGNAL_INTEL, COMM_DLC_1_PDC_STATUS /* (1,0) cm */
+#define COMM_SIG_1_PDC_STATUS_REAR_MID_RIGHT           56, 8, COMM_SIGNAL_INTEL, COMM_DLC_1_PDC_STATUS /* (1,0) cm */
+
+#define COMM_DLC_1_TIME_AND_ODO                        8
+#define COMM_SIG_1_TIME_AND_ODO_ODO                    8, 24, COMM_SIGNAL_INTEL, COMM_DLC_1_TIME_AND_ODO /* (1,0) km */
+
+#define COMM_DLC_1_COM_CLUSTER_2_RADIO                 8
+
+#define COMM_DLC_2_IGNITION                            2
+#define COMM_SIG_2_IGNITION_STATUS                     0, 8, COMM_SIGNAL_INTEL, COMM_DLC_2_IGNITION
+#define COMM_SIG_2_IGNITION_START                      8, 8, COMM_SIGNAL_INTEL, COMM_DLC_2_IGNITION
+
+#define COMM_DLC_2_REVERSE_GEAR                        7
+#define COMM_SIG_2_REVERSE_GEAR_GEAR                   16, 8, COMM_SIGNAL_INTEL, COMM_DLC_2_REVERSE_GEAR
+
+#define COMM_DLC_2_WHEEL_DATA                          8
+#define COMM_SIG_2_WHEEL_DATA_RPM                      8, 16, COMM_SIGNAL_MOTOROLA, COMM_DLC_2_WHEEL_DATA /* (1,0) rpm */
+#define COMM_SIG_2_WHEEL_DATA_SPEED                    24, 16, COMM_SIGNAL_MOTOROLA, COMM_DLC_2_WHEEL_DATA /* (0.01,0) km/h */
+#define COMM_SIG_2_WHEEL_DATA_WHEEL_LEFT               40, 16, COMM_SIGNAL_MOTOROLA, COMM_DLC_2_WHEEL_DATA
+#define COMM_SIG_2_WHEEL_DATA_WHEEL_RIGHT              56, 16, COMM_SIGNAL_MOTOROLA, COMM_DLC_2_WHEEL_DATA
+
+#define COMM_DLC_2_ODO_AND_TEMP                        7
+#define COMM_SIG_2_ODO_AND_TEMP_ODO                    0, 24, COMM_SIGNAL_INTEL, COMM_DLC_2_ODO_AND_TEMP /* (0.5,0) km */
+
+#define COMM_DLC_2_LANGUAGE_AND_UNIT                   4
+#define COMM_SIG_2_LANGUAGE_AND_UNIT_METRIC            0, 1, COMM_SIGNAL_INTEL, COMM_DLC_2_LANGUAGE_AND_UNIT
+#define COMM_SIG_2_LANGUAGE_AND_UNIT_LANGUAGE          4, 4, COMM_SIGNAL_INTEL, COMM_DLC_2_LANGUAGE_AND_UNIT
+
+#define COMM_DLC_2_VEH_CONFIG                          8
+#define COMM_SIG_2_VEH_CONFIG_STATUS                   0, 8, COMM_SIGNAL_INTEL, COMM_DLC_2_VEH_CONFIG
+#define COMM_SIG_2_VEH_CONFIG_BRAND                    19, 5, COMM_SIGNAL_INTEL, COMM_DLC_2_VEH_CONFIG
+
+#define COMM_DLC_2_DIMMING                             3
+#define COMM_SIG_2_DIMMING_DAY_NIGHT                   0, 1, COMM_SIGNAL_INTEL, COMM_DLC_2_DIMMING
+#define COMM_SIG_2_DIMMING_DISPLAY                     8, 8, COMM_SIGNAL_INTEL, COMM_DLC_2_DIMMING /* (0.5,0) % */
+#define COMM_SIG_2_DIMMING_INTERIOR                    16, 8, COMM_SIGNAL_INTEL, COMM_DLC_2_DIMMING /* (0.5,0) % */
+
+/*! @} */
+
+/**
+ * \addtogroup matrix_tx Transmit Policies of The Matrix
+ * \brief rows of comm_tx_t for each bus sending messages
+ *
+ * Rows are in the order of CANID_x_PRODUCED, COMM_TX_BIT_x_... is the bit
+ * of a message in the dirty mask of its bus, COMM_TX_COUNT_x the number
+ * of rows.
+ *
+ * @{
+ */
+
+#define COMM_TX_BIT_2_IGNITION                         (1 << 0)
+#define COMM_TX_BIT_2_REVERSE_GEAR                     (1 << 1)
+#define COMM_TX_BIT_2_WHEEL_DATA                       (1 << 2)
+#define COMM_TX_BIT_2_ODO_AND_TEMP                     (1 << 3)
+#define COMM_TX_BIT_2_LANGUAGE_AND_UNIT                (1 << 4)
+#define COMM_TX_BIT_2_VEH_CONFIG                       (1 << 5)
+#define COMM_TX_BIT_2_DIMMING                          (1 << 6)
+#define COMM_TX_COUNT_2                                7
+
+#define COMM_MATRIX_TX_2                                            \
+   { CANID_2_IGNITION, COMM_TX_CYCLIC_ON_CHANGE, CAN_TX_PRIO_HIGH,  \
+     SCHED_MS2TIME(100), SCHED_MS2TIME(10) },                       \
+   { CANID_2_REVERSE_GEAR, COMM_TX_CYCLIC_ON_CHANGE, CAN_TX_PRIO_HIGH, \
+     SCHED_MS2TIME(500), SCHED_MS2TIME(10) },                       \
+   { CANID_2_WHEEL_DATA, COMM_TX_CYCLIC, CAN_TX_PRIO_NORMAL,        \
+     SCHED_MS2TIME(100), SCHED_MS2TIME(0) },                        \
+   { CANID_2_ODO_AND_TEMP, COMM_TX_CYCLIC, CAN_TX_PRIO_LOW,         \
+     SCHED_MS2TIME(100), SCHED_MS2TIME(0) },                        \
+   { CANID_2_LANGUAGE_AND_UNIT, COMM_TX_CYCLIC, CAN_TX_PRIO_LOW,    \
+     SCHED_MS2TIME(1000), SCHED_MS2TIME(0) },                       \
+   { CANID_2_VEH_CONFIG, COMM_TX_CYCLIC, CAN_TX_PRIO_LOW,           \
+     SCHED_MS2TIME(2000), SCHED_MS2TIME(0) },                       \
+   { CANID_2_DIMMING, COMM_TX_CYCLIC_ON_CHANGE, CAN_TX_PRIO_NORMAL, \
+     SCHED_MS2TIME(500), SCHED_MS2TIME(100) },
+
+/*! @} */
+
+/**
+ * \def COMM_MATRIX_SIGNALS
+ * \brief rows of comm_signal_t routed from CAN1 to CAN2
+ *
+ * dst = ((src * factor) >> shift) + offset
+ */
+#define COMM_MATRIX_SIGNALS                                         \
+   /* 1.WHEEL_GEAR_DATA.SPEED -> 2.WHEEL_DATA.SPEED */              \
+   { CANID_1_WHEEL_GEAR_DATA, 9, 15, COMM_SIGNAL_INTEL, 1, 0, 0,    \
+     CANID_2_WHEEL_DATA, 24, 16, COMM_SIGNAL_MOTOROLA },            \
+   /* 1.RPM_STATUS.RPM -> 2.WHEEL_DATA.RPM */                       \
+   { CANID_1_RPM_STATUS, 8, 16, COMM_SIGNAL_INTEL, 1, 2, 0,         \
+     CANID_2_WHEEL_DATA, 8, 16, COMM_SIGNAL_MOTOROLA },             \
+   /* 1.TIME_AND_ODO.ODO -> 2.ODO_AND_TEMP.ODO */                   \
+   { CANID_1_TIME_AND_ODO, 8, 24, COMM_SIGNAL_INTEL, 2, 0, 0,       \
+     CANID_2_ODO_AND_TEMP, 0, 24, COMM_SIGNAL_INTEL },
+
+#endif /* COMM_MATRIX_GEN_H_ */
@@ -0,0 +1,193 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file comm_persist.c
+ *
+ * \date Created: 16.10.2026 21:18:44
+ * \author agent
+ **/
+
+
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "../modules/can/can_mcp2515.h"
+#include "../can_io/can_tx.h"
+
+#include "comm_signal.h"
+#include "comm_matrix.h"
+#include "comm_persist.h"
+
+/***************************************************************************/
+/* VARIABLES                                                               */
+/***************************************************************************/
+
+//! compilation fails, if the ring overlaps the signal matrix or exceeds the
+//! EEPROM
+typedef char comm_persistFits[
+   ((COMM_PERSIST_EEPROM_ADDR >= COMM_MATRIX_EEPROM_ADDR +
+                                 sizeof(comm_matrix_header_t) +
+                                 COMM_MATRIX_MAX_SIGNALS *
+                                 sizeof(comm_signal_t)) &&
+    (COMM_PERSIST_EEPROM_ADDR +
+     COMM_PERSIST_SLOTS * sizeof(comm_persist_record_t) <= E2END + 1))
+   ? 1 : -1];
+
+//! snapshot saved or loaded last
+comm_persist_record_t comm_persistLast;
+
+//! a valid record was found or written
+bool comm_persistValid = false;
+
+//! statistics of the snapshot ring
+comm_persist_stats_t comm_persistStats;
+
+/***************************************************************************/
+/* HELPERS                                                                 */
+/***************************************************************************/
+
+/**
+ * \brief get EEPROM address of a slot
+ * \param slot - slot of the ring
+ * \return address
+ */
+comm_persist_record_t* comm_persist_address(uint8_t slot)
+{
+   return (comm_persist_record_t*)(COMM_PERSIST_EEPROM_ADDR +
+                                   slot * sizeof(comm_persist_record_t));
+}
+
+/**
+ * \brief calculate the CRC of a record
+ * \param record - record to check
+ * \return CRC16 of all bytes but the crc itself
+ */
+uint16_t comm_persist_crc(const comm_persist_record_t* record)
+{
+   const uint8_t* data = (const uint8_t*)record;
+   uint16_t       crc  = 0xFFFF;
+   uint8_t        i;
+
+   for(i = 0; i < offsetof(comm_persist_record_t, crc); ++i)
+   {
+      crc = _crc16_update(crc, data[i]);
+   }
+
+   return crc;
+}
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief find the newest valid snapshot in EEPROM
+ * \param data - snapshot read
+ * \return true, if a valid snapshot was found
+ *
+ * Call once at start up, before comm_persist_save().
+ */
+bool comm_persist_load(comm_persist_data_t* data)
+{
+   comm_persist_record_t record;
+   uint8_t               slot;
+
+   comm_persistValid = false;
+
+   for(slot = 0; slot < COMM_PERSIST_SLOTS; ++slot)
+   {
+      eeprom_read_block(&record, comm_persist_address(slot), sizeof(record));
+
+      if(record.crc != comm_persist_crc(&record))
+      {
+         // erased, never written or torn by power loss
+         if(UINT8_MAX != comm_persistStats.invalid)
+         {
+            ++comm_persistStats.invalid;
+         }
+         continue;
+      }
+
+      // sequences of the ring are close, so the difference survives a wrap
+      if((false == comm_persistValid) ||
+         ((int16_t)(record.sequence - comm_persistLast.sequence) > 0))
+      {
+         comm_persistLast         = record;
+         comm_persistValid        = true;
+         comm_persistStats.slot   = slot;
+      }
+   }
+
+   if(false == comm_persistValid)
+   {
+      // next save goes to slot 0
+      comm_persistStats.slot = COMM_PERSIST_SLOTS - 1;
+      return false;
+   }
+
+   comm_persistStats.sequence = comm_persistLast.sequence;
+   *data = comm_persistLast.data;
+   return true;
+}
+
+/**
+ * \brief write a snapshot into the next slot of the ring
+ * \param data - snapshot to write
+ *
+ * Blocks ~8.5ms per byte written (sizeof(comm_persist_record_t)), so call
+ * when nothing else is to be done, e.g. before sleep.
+ */
+void comm_persist_save(const comm_persist_data_t* data)
+{
+   comm_persist_stats_t* stats = &comm_persistStats;
+
+   if((true == comm_persistValid) &&
+      (0 == memcmp(data, &comm_persistLast.data, sizeof(*data))))
+   {
+      if(UINT16_MAX != stats->unchanged)
+      {
+         ++stats->unchanged;
+      }
+      return;
+   }
+
+   comm_persistLast.sequence = (true == comm_persistValid)
+                             ? comm_persistLast.sequence + 1 : 0;
+   comm_persistLast.data     = *data;
+   comm_persistLast.crc      = comm_persist_crc(&comm_persistLast);
+
+   stats->slot = (stats->slot + 1) % COMM_PERSIST_SLOTS;
+   // bytes already holding their value are not written again
+   eeprom_update_block(&comm_persistLast, comm_persist_address(stats->slot),
+                       sizeof(comm_persistLast));
+
+   comm_persistValid = true;
+   stats->sequence   = comm_persistLast.sequence;
+   if(UINT16_MAX != stats->saves)
+   {
+      ++stats->saves;
+   }
+}
+
+/**
+ * \brief get statistics of the snapshot ring
+ * \return pointer to statistics
+ */
+comm_persist_stats_t* comm_persist_getStats(void)
+{
+   return &comm_persistStats;
+}
@@ -0,0 +1,157 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file comm_persist.h
+ *
+ * Snapshot of slow signals (odometer, dimming, language, units) kept in
+ * EEPROM over power off, so the first CAN2 frames after a cold boot carry
+ * the values known last instead of zeros.
+ *
+ * The snapshots are written into a ring of COMM_PERSIST_SLOTS records
+ * behind the signal matrix, one slot further per save. Each record has a
+ * sequence number and a CRC16, the valid record with the highest sequence
+ * is the one to restore. A record torn by power loss fails its CRC, so the
+ * one before is used. A snapshot equal to the one saved last is not written
+ * again, so each cell is written once per COMM_PERSIST_SLOTS changes only.
+ *
+ * \date Created: 16.10.2026 21:18:44
+ * \author agent
+ **/
+
+
+#ifndef COMM_PERSIST_H_
+#define COMM_PERSIST_H_
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \addtogroup comm_persist_definitions Persisted Signal Snapshot
+ * \brief definitions for the snapshot ring in EEPROM
+ *
+ * EEPROM layout of a record (little endian, packed):
+ * \code
+ * byte 0..9  : snapshot (see comm_persist_data_t)
+ * byte 10..11: sequence number
+ * byte 12..13: CRC16 of bytes 0..11 (_crc16_update(), 0xFFFF)
+ * \endcode
+ * @{
+ */
+
+/**
+ * \def COMM_PERSIST_EEPROM_ADDR
+ * \brief start address of the ring in EEPROM
+ *
+ * Second half of the EEPROM, the first one is left to the signal matrix.
+ */
+#define COMM_PERSIST_EEPROM_ADDR    0x0100
+
+/**
+ * \def COMM_PERSIST_SLOTS
+ * \brief number of records in the ring
+ */
+#define COMM_PERSIST_SLOTS          16
+
+/**
+ * \def COMM_PERSIST_NIGHT
+ * \brief comm_persist_data_t::flags: night mode
+ *
+ * \def COMM_PERSIST_METRIC
+ * \brief comm_persist_data_t::flags: metric units
+ */
+#define COMM_PERSIST_NIGHT          (1 << 0)
+#define COMM_PERSIST_METRIC         (1 << 1)
+
+/*! @} */
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief snapshot of slow signals
+ */
+typedef struct
+{
+   //! converted odometer (comm_store_t::values)
+   uint32_t odometer;
+   //! revision of signal matrix the odometer was converted by
+   uint16_t revision;
+   //! average of dimming values
+   uint16_t dimAverage;
+   //! language setup
+   uint8_t  language;
+   //! COMM_PERSIST_NIGHT, COMM_PERSIST_METRIC
+   uint8_t  flags;
+} comm_persist_data_t;
+
+/**
+ * \brief record of the ring in EEPROM
+ */
+typedef struct
+{
+   //! snapshot
+   comm_persist_data_t data;
+   //! sequence number, incremented per save
+   uint16_t            sequence;
+   //! CRC16 of sequence and snapshot
+   uint16_t            crc;
+} comm_persist_record_t;
+
+/**
+ * \brief statistics of the snapshot ring
+ */
+typedef struct
+{
+   //! slot of the record valid last
+   uint8_t  slot;
+   //! records failing their CRC found by comm_persist_load()
+   uint8_t  invalid;
+   //! sequence number of the record valid last
+   uint16_t sequence;
+   //! snapshots written since power up
+   uint16_t saves;
+   //! snapshots not written, since nothing changed
+   uint16_t unchanged;
+} comm_persist_stats_t;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief find the newest valid snapshot in EEPROM
+ * \param data - snapshot read
+ * \return true, if a valid snapshot was found
+ *
+ * Call once at start up, before comm_persist_save().
+ */
+bool comm_persist_load(comm_persist_data_t* data);
+
+/**
+ * \brief write a snapshot into the next slot of the ring
+ * \param data - snapshot to write
+ *
+ * Blocks ~8.5ms per byte written (sizeof(comm_persist_record_t)), so call
+ * when nothing else is to be done, e.g. before sleep.
+ */
+void comm_persist_save(const comm_persist_data_t* data);
+
+/**
+ * \brief get statistics of the snapshot ring
+ * \return pointer to statistics
+ */
+comm_persist_stats_t* comm_persist_getStats(void);
+
+#endif /* COMM_PERSIST_H_ */
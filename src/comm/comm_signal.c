@@ -0,0 +1,202 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file comm_signal.c
+ *
+ * \date Created: 16.10.2026 20:43:33
+ * \author agent
+ **/
+
+
+#include "../modules/can/can_mcp2515.h"
+
+#include "comm_signal.h"
+
+/***************************************************************************/
+/* HELPERS                                                                 */
+/***************************************************************************/
+
+/**
+ * \brief check position of a signal within 8 data bytes
+ * \param start - least significant bit of signal
+ * \param length - length in bits
+ * \param order - byte order
+ * \return true, if all bits are within the message
+ */
+bool comm_signal_fits(uint8_t start, uint8_t length, comm_signal_order_t order)
+{
+   uint8_t bytes;
+
+   if((0 == length) || (32 < length) || (63 < start) ||
+      (COMM_SIGNAL_MOTOROLA < order))
+   {
+      return false;
+   }
+
+   // number of further bytes touched after the start byte
+   bytes = ((start & 7) + length - 1) >> 3;
+
+   return (COMM_SIGNAL_INTEL == order) ? ((start >> 3) + bytes < 8)
+                                       : ((start >> 3) >= bytes);
+}
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief extract a raw signal value from message data
+ * \param data - message data (8 bytes)
+ * \param start - least significant bit of signal
+ * \param length - length in bits (1..32)
+ * \param order - byte order
+ * \return raw value
+ *
+ * Works byte-wise: at most 5 bytes are touched for a 32bit signal.
+ */
+uint32_t comm_signal_extract(const uint8_t*      data,
+                             uint8_t             start,
+                             uint8_t             length,
+                             comm_signal_order_t order)
+{
+   int8_t   step  = (COMM_SIGNAL_INTEL == order) ? 1 : -1;
+   uint8_t  index = start >> 3;
+   uint8_t  got   = 8 - (start & 7);
+   uint32_t value = data[index] >> (start & 7);
+
+   while(got < length)
+   {
+      index += step;
+      value |= (uint32_t)data[index] << got;
+      got   += 8;
+   }
+
+   if(length < 32)
+   {
+      value &= ((uint32_t)1 << length) - 1;
+   }
+
+   return value;
+}
+
+/**
+ * \brief insert a raw signal value into message data
+ * \param data - message data (8 bytes)
+ * \param start - least significant bit of signal
+ * \param length - length in bits (1..32)
+ * \param order - byte order
+ * \param value - raw value (truncated to length)
+ *
+ * Bits outside of the signal are kept.
+ */
+void comm_signal_insert(uint8_t*            data,
+                        uint8_t             start,
+                        uint8_t             length,
+                        comm_signal_order_t order,
+                        uint32_t            value)
+{
+   int8_t  step  = (COMM_SIGNAL_INTEL == order) ? 1 : -1;
+   uint8_t index = start >> 3;
+   uint8_t shift = start & 7;
+   uint8_t bits;
+   uint8_t mask;
+
+   while(0 != length)
+   {
+      // bits of signal within this byte
+      bits = 8 - shift;
+      if(bits > length)
+      {
+         bits = length;
+      }
+      mask = (uint8_t)(((1 << bits) - 1) << shift);
+
+      data[index] = (data[index] & ~mask) | (((uint8_t)value << shift) & mask);
+
+      value  >>= bits;
+      length  -= bits;
+      shift    = 0;
+      index   += step;
+   }
+}
+
+/**
+ * \brief check a signal description for sane positions
+ * \param signal - signal to check
+ * \return true, if source and destination fit into 8 data bytes
+ */
+bool comm_signal_isValid(const comm_signal_t* signal)
+{
+   return comm_signal_fits(signal->srcStart, signal->srcLength,
+                           signal->srcOrder) &&
+          comm_signal_fits(signal->dstStart, signal->dstLength,
+                           signal->dstOrder) &&
+          (signal->shift < 32);
+}
+
+/**
+ * \brief decode all signals of a message
+ * \param table - signal table
+ * \param size - number of signals
+ * \param values - converted value of each signal
+ * \param msg - received CAN message
+ */
+void comm_signal_decode(const comm_signal_t* table,
+                        uint8_t              size,
+                        uint32_t*            values,
+                        can_t*               msg)
+{
+   const comm_signal_t* signal = table;
+   uint8_t              i;
+
+   for(i = 0; i < size; ++i, ++signal)
+   {
+      if(signal->srcId == msg->msgId)
+      {
+         values[i] = comm_signal_extract(msg->data,
+                                         signal->srcStart,
+                                         signal->srcLength,
+                                         signal->srcOrder);
+         values[i] = ((values[i] * signal->factor) >> signal->shift) +
+                     signal->offset;
+      }
+   }
+}
+
+/**
+ * \brief encode all signals of a message
+ * \param table - signal table
+ * \param size - number of signals
+ * \param values - converted value of each signal
+ * \param msg - CAN message to fill
+ */
+void comm_signal_encode(const comm_signal_t* table,
+                        uint8_t              size,
+                        const uint32_t*      values,
+                        can_t*               msg)
+{
+   const comm_signal_t* signal = table;
+   uint8_t              i;
+
+   for(i = 0; i < size; ++i, ++signal)
+   {
+      if(signal->dstId == msg->msgId)
+      {
+         comm_signal_insert(msg->data,
+                            signal->dstStart,
+                            signal->dstLength,
+                            signal->dstOrder,
+                            values[i]);
+      }
+   }
+}
@@ -0,0 +1,148 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file comm_signal.h
+ *
+ * Table driven signal matrix. Each signal is described by its position in
+ * the source message, a conversion and its position in the destination
+ * message. One extract/insert kernel handles all signals byte-wise, so
+ * adding a signal is a table row instead of new shift/mask code.
+ *
+ * \date Created: 16.10.2026 20:43:33
+ * \author agent
+ **/
+
+
+#ifndef COMM_SIGNAL_H_
+#define COMM_SIGNAL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../modules/can/can_mcp2515.h"
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief byte order of a signal
+ *
+ * The start bit is always the least significant bit of the signal, counted
+ * as (byte * 8 + bit).
+ */
+typedef enum
+{
+   //! little endian, more significant bits in following bytes
+   COMM_SIGNAL_INTEL    = 0,
+   //! big endian, more significant bits in preceding bytes
+   COMM_SIGNAL_MOTOROLA = 1
+} comm_signal_order_t;
+
+/**
+ * \brief description of a signal routed from one message to another
+ *
+ * The value is converted as ((raw * factor) >> shift) + offset, so no
+ * division is needed on the AVR.
+ */
+typedef struct
+{
+   //! source CAN id
+   uint16_t            srcId;
+   //! least significant bit in source message
+   uint8_t             srcStart;
+   //! length in bits in source message (1..32)
+   uint8_t             srcLength;
+   //! byte order in source message
+   comm_signal_order_t srcOrder;
+   //! multiplier of raw value
+   uint8_t             factor;
+   //! right shift after multiplication (divisor 2^shift)
+   uint8_t             shift;
+   //! offset added after scaling
+   int16_t             offset;
+   //! destination CAN id
+   uint16_t            dstId;
+   //! least significant bit in destination message
+   uint8_t             dstStart;
+   //! length in bits in destination message (1..32)
+   uint8_t             dstLength;
+   //! byte order in destination message
+   comm_signal_order_t dstOrder;
+} comm_signal_t;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief extract a raw signal value from message data
+ * \param data - message data (8 bytes)
+ * \param start - least significant bit of signal
+ * \param length - length in bits (1..32)
+ * \param order - byte order
+ * \return raw value
+ */
+uint32_t comm_signal_extract(const uint8_t*      data,
+                             uint8_t             start,
+                             uint8_t             length,
+                             comm_signal_order_t order);
+
+/**
+ * \brief insert a raw signal value into message data
+ * \param data - message data (8 bytes)
+ * \param start - least significant bit of signal
+ * \param length - length in bits (1..32)
+ * \param order - byte order
+ * \param value - raw value (truncated to length)
+ *
+ * Bits outside of the signal are kept.
+ */
+void comm_signal_insert(uint8_t*            data,
+                        uint8_t             start,
+                        uint8_t             length,
+                        comm_signal_order_t order,
+                        uint32_t            value);
+
+/**
+ * \brief check a signal description for sane positions
+ * \param signal - signal to check
+ * \return true, if source and destination fit into 8 data bytes
+ */
+bool comm_signal_isValid(const comm_signal_t* signal);
+
+/**
+ * \brief decode all signals of a message
+ * \param table - signal table
+ * \param size - number of signals
+ * \param values - converted value of each signal
+ * \param msg - received CAN message
+ */
+void comm_signal_decode(const comm_signal_t* table,
+                        uint8_t              size,
+                        uint32_t*            values,
+                        can_t*               msg);
+
+/**
+ * \brief encode all signals of a message
+ * \param table - signal table
+ * \param size - number of signals
+ * \param values - converted value of each signal
+ * \param msg - CAN message to fill
+ */
+void comm_signal_encode(const comm_signal_t* table,
+                        uint8_t              size,
+                        const uint32_t*      values,
+                        can_t*               msg);
+
+#endif /* COMM_SIGNAL_H_ */
@@ -0,0 +1,167 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file comm_sleep.c
+ *
+ * \date Created: 16.10.2026 21:23:03
+ * \author agent
+ **/
+
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <stdbool.h>
+
+#include "../modules/can/can_mcp2515.h"
+#include "../can_io/can_tx.h"
+
+#include "comm_can_ids.h"
+#include "comm_matrix.h"
+#include "comm_matrix_gen.h"
+#include "comm_sleep.h"
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+//! expands an entry of the id registry into its id
+#define COMM_SLEEP_ID(id, handler, dirty)    id,
+
+/***************************************************************************/
+/* VARIABLES                                                               */
+/***************************************************************************/
+
+//! consumed ids of CAN1 keeping the network awake
+const uint16_t comm_sleepIds[] PROGMEM =
+{
+   CANID_1_CONSUMED(COMM_SLEEP_ID)
+};
+
+//! compilation fails, if the ids do not fit into the activity mask
+typedef char comm_sleepIdsFit[(ARRAY_SIZE(comm_sleepIds) <= 8) ? 1
+                                                                        : -1];
+
+//! quiet time per ignition state in periods
+const uint8_t comm_sleepQuiet[COMM_SLEEP_STATES] PROGMEM =
+{
+   COMM_SLEEP_MS2PERIODS(COMM_SLEEP_QUIET_OFF_MS),
+   COMM_SLEEP_MS2PERIODS(COMM_SLEEP_QUIET_ACC_MS),
+   COMM_SLEEP_MS2PERIODS(COMM_SLEEP_QUIET_ON_MS)
+};
+
+//! consumed ids received since last period
+volatile uint8_t comm_sleepActive = 0;
+
+//! ignition state decoded last
+volatile comm_sleep_ign_t comm_sleepIgnition = COMM_SLEEP_IGN_OFF;
+
+//! statistics of the bus sleep policy
+comm_sleep_stats_t comm_sleepStats;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief start over, e.g. after wake up
+ *
+ * The ignition state is unknown until decoded and taken as off.
+ */
+void comm_sleep_init(void)
+{
+   comm_sleepActive      = 0;
+   comm_sleepIgnition    = COMM_SLEEP_IGN_OFF;
+   comm_sleepStats.quiet = 0;
+}
+
+/**
+ * \brief note a consumed frame of CAN1
+ * \param msgId - CAN id
+ *
+ * Ids not consumed are ignored.
+ */
+void comm_sleep_activity(uint16_t msgId)
+{
+   uint8_t i;
+
+   for(i = 0; i < ARRAY_SIZE(comm_sleepIds); ++i)
+   {
+      if(msgId == pgm_read_word(&comm_sleepIds[i]))
+      {
+         comm_sleepActive |= (1 << i);
+         break;
+      }
+   }
+}
+
+/**
+ * \brief set ignition state decoded
+ * \param state - ignition state
+ */
+void comm_sleep_setIgnition(comm_sleep_ign_t state)
+{
+   comm_sleepIgnition = state;
+}
+
+/**
+ * \brief decide whether CAN1 sleeps
+ * \return true, if the network is quiet for the time of its ignition state
+ *
+ * Periodic job of COMM_SLEEP_PERIOD_MS.
+ */
+bool comm_sleep_run(void)
+{
+   comm_sleep_stats_t* stats = &comm_sleepStats;
+   comm_sleep_ign_t    state = comm_sleepIgnition;
+   uint8_t             quiet = pgm_read_byte(&comm_sleepQuiet[state]);
+   uint8_t             saved;
+
+   stats->active    = comm_sleepActive;
+   comm_sleepActive = 0;
+
+   if(UINT32_MAX != stats->residency[state])
+   {
+      ++stats->residency[state];
+   }
+
+   if(0 != stats->active)
+   {
+      stats->quiet = 0;
+      return false;
+   }
+
+   if(++stats->quiet < quiet)
+   {
+      return false;
+   }
+
+   // awake time saved compared to the fixed quiet time
+   saved = COMM_SLEEP_MS2PERIODS(COMM_SLEEP_QUIET_ON_MS) - quiet;
+   stats->saved = (stats->saved > UINT32_MAX - saved) ? UINT32_MAX
+                                                      : stats->saved + saved;
+   if(UINT16_MAX != stats->sleeps[state])
+   {
+      ++stats->sleeps[state];
+   }
+
+   return true;
+}
+
+/**
+ * \brief get statistics of the bus sleep policy
+ * \return pointer to statistics
+ */
+comm_sleep_stats_t* comm_sleep_getStats(void)
+{
+   return &comm_sleepStats;
+}
@@ -0,0 +1,154 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file comm_sleep.h
+ *
+ * Bus sleep policy of CAN1. The network is asleep, if none of the consumed
+ * ids (CANID_1_CONSUMED) was received for the quiet time of the ignition
+ * state decoded last:
+ *
+ * * ignition on  - COMM_SLEEP_QUIET_ON_MS, the network should not sleep
+ * * accessory    - COMM_SLEEP_QUIET_ACC_MS
+ * * ignition off - COMM_SLEEP_QUIET_OFF_MS, the network is going down
+ *
+ * Frames passing the filters without being consumed, e.g. diagnostics,
+ * keep nothing awake. comm_sleep_run() is a periodic job and tells when to
+ * go to sleep. The residency counters show the time spent in each ignition
+ * state and the time saved compared to a fixed COMM_SLEEP_QUIET_ON_MS.
+ *
+ * \date Created: 16.10.2026 21:23:03
+ * \author agent
+ **/
+
+
+#ifndef COMM_SLEEP_H_
+#define COMM_SLEEP_H_
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \addtogroup comm_sleep_definitions Bus Sleep Policy
+ * \brief definitions for detecting the sleep of CAN1
+ * @{
+ */
+
+/**
+ * \def COMM_SLEEP_PERIOD_MS
+ * \brief period of comm_sleep_run() in ms
+ */
+#define COMM_SLEEP_PERIOD_MS        100
+
+/**
+ * \def COMM_SLEEP_MS2PERIODS
+ * \brief convert ms to periods of comm_sleep_run()
+ */
+#define COMM_SLEEP_MS2PERIODS(ms)   ((ms) / COMM_SLEEP_PERIOD_MS)
+
+/**
+ * \def COMM_SLEEP_QUIET_OFF_MS
+ * \brief quiet time with ignition off in ms
+ *
+ * \def COMM_SLEEP_QUIET_ACC_MS
+ * \brief quiet time with accessory on or key inserted in ms
+ *
+ * \def COMM_SLEEP_QUIET_ON_MS
+ * \brief quiet time with ignition on in ms (former fixed time of Timer1)
+ *
+ * Up to 25500ms.
+ */
+#define COMM_SLEEP_QUIET_OFF_MS     2000
+#define COMM_SLEEP_QUIET_ACC_MS     5000
+#define COMM_SLEEP_QUIET_ON_MS      15000
+
+/*! @} */
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief ignition state deciding the quiet time
+ */
+typedef enum
+{
+   //! ignition off
+   COMM_SLEEP_IGN_OFF = 0,
+   //! accessory on or key inserted
+   COMM_SLEEP_IGN_ACC = 1,
+   //! ignition on
+   COMM_SLEEP_IGN_ON  = 2,
+   //! number of states
+   COMM_SLEEP_STATES  = 3
+} comm_sleep_ign_t;
+
+/**
+ * \brief statistics of the bus sleep policy
+ *
+ * Times are in periods of comm_sleep_run() and saturate.
+ */
+typedef struct
+{
+   //! time awake per ignition state
+   uint32_t residency[COMM_SLEEP_STATES];
+   //! sleeps entered per ignition state
+   uint16_t sleeps[COMM_SLEEP_STATES];
+   //! time awake saved compared to COMM_SLEEP_QUIET_ON_MS for all states
+   uint32_t saved;
+   //! consumed ids received during the last period (bit per CANID_1_CONSUMED)
+   uint8_t  active;
+   //! periods since the last consumed id
+   uint8_t  quiet;
+} comm_sleep_stats_t;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief start over, e.g. after wake up
+ *
+ * The ignition state is unknown until decoded and taken as off.
+ */
+void comm_sleep_init(void);
+
+/**
+ * \brief note a consumed frame of CAN1
+ * \param msgId - CAN id
+ *
+ * Ids not consumed are ignored.
+ */
+void comm_sleep_activity(uint16_t msgId);
+
+/**
+ * \brief set ignition state decoded
+ * \param state - ignition state
+ */
+void comm_sleep_setIgnition(comm_sleep_ign_t state);
+
+/**
+ * \brief decide whether CAN1 sleeps
+ * \return true, if the network is quiet for the time of its ignition state
+ *
+ * Periodic job of COMM_SLEEP_PERIOD_MS.
+ */
+bool comm_sleep_run(void);
+
+/**
+ * \brief get statistics of the bus sleep policy
+ * \return pointer to statistics
+ */
+comm_sleep_stats_t* comm_sleep_getStats(void);
+
+#endif /* COMM_SLEEP_H_ */
@@ -0,0 +1,107 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file comm_store.c
+ *
+ * \date Created: 16.10.2026 20:54:11
+ * \author agent
+ **/
+
+
+#include <avr/io.h>
+#include <string.h>
+
+#include "../modules/can/can_mcp2515.h"
+#include "../can_io/can_tx.h"
+
+#include "comm_matrix.h"
+#include "comm_store.h"
+
+/***************************************************************************/
+/* VARIABLES                                                               */
+/***************************************************************************/
+
+//! values written by the decoders
+comm_store_t comm_storeShared;
+
+//! sequence of updates, odd while an update is in progress
+volatile uint8_t comm_storeSequence = 0;
+
+//! number of snapshots repeated
+uint16_t comm_storeRetries = 0;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief start writing the store
+ * \return store to write
+ *
+ * Only one writer at a time and it must not be interrupted by a reader,
+ * e.g. decoding in an ISR and snapshots in the main loop.
+ */
+comm_store_t* comm_store_beginUpdate(void)
+{
+   ++comm_storeSequence;
+   COMM_STORE_BARRIER();
+   return &comm_storeShared;
+}
+
+/**
+ * \brief finish writing the store
+ */
+void comm_store_endUpdate(void)
+{
+   COMM_STORE_BARRIER();
+   ++comm_storeSequence;
+}
+
+/**
+ * \brief get a consistent copy of the store
+ * \param copy - destination of copy
+ */
+void comm_store_snapshot(comm_store_t* copy)
+{
+   uint8_t sequence;
+
+   for(;;)
+   {
+      sequence = comm_storeSequence;
+
+      // no update in progress
+      if(0 == (sequence & 1))
+      {
+         COMM_STORE_BARRIER();
+         memcpy(copy, &comm_storeShared, sizeof(comm_store_t));
+         COMM_STORE_BARRIER();
+
+         // no update happened while copying
+         if(sequence == comm_storeSequence)
+         {
+            return;
+         }
+      }
+
+      ++comm_storeRetries;
+   }
+}
+
+/**
+ * \brief get number of snapshots repeated due to concurrent updates
+ * \return number of repetitions
+ */
+uint16_t comm_store_getRetries(void)
+{
+   return comm_storeRetries;
+}
@@ -0,0 +1,100 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file comm_store.h
+ *
+ * Signal store between decoders (reception) and encoders (transmission).
+ * The decoders write the store within comm_store_beginUpdate() and
+ * comm_store_endUpdate(), which increment a sequence counter. Encoders work
+ * on a snapshot, which is copied again, if an update happened meanwhile.
+ * So decoding may run in interrupt context without any cli()/sei() around
+ * encoding, and multi-byte values like wheelOut never tear.
+ *
+ * Cost: a snapshot copies sizeof(comm_store_t) bytes (~4 cycles per byte),
+ * updates just increment the sequence twice. A reader is never blocked, it
+ * repeats its copy only if a frame was decoded while copying.
+ *
+ * \date Created: 16.10.2026 20:54:11
+ * \author agent
+ **/
+
+
+#ifndef COMM_STORE_H_
+#define COMM_STORE_H_
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \def COMM_STORE_BARRIER
+ * \brief keep the compiler from moving memory accesses across
+ */
+#define COMM_STORE_BARRIER()     __asm__ __volatile__ ("" ::: "memory")
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief values decoded from CAN1 to be sent to CAN2
+ */
+typedef struct
+{
+   //! wheel signal (as-is)
+   uint16_t wheelIn;
+   //! wheel signal (full 16bit)
+   uint16_t wheelOut;
+   //! ignition key status (destination)
+   uint8_t  ignition;
+   //! gear box status (destination)
+   uint8_t  gearBox;
+   //! headlights status (destination) on/off
+   uint8_t  headlights;
+   //! ambient temperature
+   uint8_t  temp;
+   //! converted values of comm_signals
+   uint32_t values[COMM_MATRIX_MAX_SIGNALS];
+} comm_store_t;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief start writing the store
+ * \return store to write
+ *
+ * Only one writer at a time and it must not be interrupted by a reader,
+ * e.g. decoding in an ISR and snapshots in the main loop.
+ */
+comm_store_t* comm_store_beginUpdate(void);
+
+/**
+ * \brief finish writing the store
+ */
+void comm_store_endUpdate(void);
+
+/**
+ * \brief get a consistent copy of the store
+ * \param copy - destination of copy
+ */
+void comm_store_snapshot(comm_store_t* copy);
+
+/**
+ * \brief get number of snapshots repeated due to concurrent updates
+ * \return number of repetitions
+ */
+uint16_t comm_store_getRetries(void);
+
+#endif /* COMM_STORE_H_ */
@@ -0,0 +1,196 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file comm_timing.c
+ *
+ * \date Created: 16.10.2026 21:11:38
+ * \author agent
+ **/
+
+
+#include <avr/io.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../sched/scheduler.h"
+#include "../sched/timebase.h"
+
+#include "comm_matrix_gen.h"
+#include "comm_timing.h"
+
+#ifdef PROFILE_ENABLE
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+//! timestamp units per unit of sched_getTime()
+#define COMM_TIMING_PER_SCHED_UNIT                                         \
+   (SCHED_TIME_UNIT_US / (TIMEBASE_UNIT_US << COMM_TIMING_UNIT_SHIFT))
+
+/***************************************************************************/
+/* VARIABLES                                                               */
+/***************************************************************************/
+
+//! timing histograms
+comm_timing_t comm_timing;
+
+//! oldest decode of a source not loaded yet (event driven messages) or
+//! last load (cyclic messages)
+uint16_t comm_timingStamp[COMM_TX_COUNT_2];
+
+//! messages with a valid timestamp (bit per message)
+uint8_t comm_timingValid = 0;
+
+//! event driven messages (bit per message)
+uint8_t comm_timingEvents = 0;
+
+/***************************************************************************/
+/* HELPERS                                                                 */
+/***************************************************************************/
+
+/**
+ * \brief get current timestamp
+ * \return time in units of TIMEBASE_UNIT_US << COMM_TIMING_UNIT_SHIFT
+ */
+uint16_t comm_timing_now(void)
+{
+   return (uint16_t)(timebase_get() >> COMM_TIMING_UNIT_SHIFT);
+}
+
+/**
+ * \brief count a value in a histogram
+ * \param histogram - buckets
+ * \param value - value in timestamp units
+ * \param base - log2 of upper limit of first bucket
+ */
+void comm_timing_count(uint8_t* histogram, uint16_t value, uint8_t base)
+{
+   uint8_t bucket = 0;
+   uint8_t i;
+
+   value >>= base;
+   while((0 != value) && (bucket < (COMM_TIMING_BUCKETS - 1)))
+   {
+      value >>= 1;
+      ++bucket;
+   }
+
+   if(UINT8_MAX == histogram[bucket])
+   {
+      for(i = 0; i < COMM_TIMING_BUCKETS; ++i)
+      {
+         histogram[i] >>= 1;
+      }
+   }
+   ++histogram[bucket];
+}
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief forget pending timestamps, e.g. after wake up
+ * \param events - bits of event driven messages (COMM_TX_BIT_2_...), the
+ *                 other messages are cyclic only
+ *
+ * Histograms are kept.
+ */
+void comm_timing_init(uint8_t events)
+{
+   comm_timingValid  = 0;
+   comm_timingEvents = events;
+}
+
+/**
+ * \brief timestamp the decode of a source message
+ * \param mask - bits of CAN2 messages depending on it (COMM_TX_BIT_2_...)
+ */
+void comm_timing_received(uint8_t mask)
+{
+   uint16_t now;
+   uint8_t  i;
+
+   // keep the oldest decode not loaded yet
+   mask &= comm_timingEvents & ~comm_timingValid;
+   if(0 == mask)
+   {
+      return;
+   }
+
+   now               = comm_timing_now();
+   comm_timingValid |= mask;
+   for(i = 0; i < COMM_TX_COUNT_2; ++i, mask >>= 1)
+   {
+      if(mask & 1)
+      {
+         comm_timingStamp[i] = now;
+      }
+   }
+}
+
+/**
+ * \brief count latency or jitter of a CAN2 message loaded for transmission
+ * \param index - index of message (order of COMM_MATRIX_TX_2)
+ * \param cycle - cycle of message (units of sched_getTime())
+ */
+void comm_timing_loaded(uint8_t index, uint16_t cycle)
+{
+   uint16_t now = comm_timing_now();
+   uint8_t  bit = (1 << index);
+   int16_t  deviation;
+
+   if(comm_timingEvents & bit)
+   {
+      if(comm_timingValid & bit)
+      {
+         comm_timingValid &= ~bit;
+         comm_timing_count(comm_timing.latency,
+                           now - comm_timingStamp[index],
+                           COMM_TIMING_LATENCY_BASE);
+      }
+      return;
+   }
+
+   if(comm_timingValid & bit)
+   {
+      deviation = (int16_t)(now - comm_timingStamp[index] -
+                            cycle * COMM_TIMING_PER_SCHED_UNIT);
+      comm_timing_count(comm_timing.jitter,
+                        (uint16_t)((deviation < 0) ? -deviation : deviation),
+                        COMM_TIMING_JITTER_BASE);
+   }
+
+   comm_timingStamp[index] = now;
+   comm_timingValid       |= bit;
+}
+
+/**
+ * \brief clear all histograms
+ */
+void comm_timing_clear(void)
+{
+   memset(&comm_timing, 0, sizeof(comm_timing));
+}
+
+/**
+ * \brief get timing histograms
+ * \return pointer to histograms
+ */
+comm_timing_t* comm_timing_get(void)
+{
+   return &comm_timing;
+}
+
+#endif
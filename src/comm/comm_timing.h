@@ -0,0 +1,133 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file comm_timing.h
+ *
+ * Latency and jitter of the CAN2 messages as histograms in RAM, timestamped
+ * by timebase_get() when can_tx_service() loads a frame into a transmit
+ * buffer of the MCP2515:
+ *
+ * * latency - from decoding a CAN1 source message (fetchInfoFromCAN1()) to
+ *   loading the event driven CAN2 message depending on it. Signals of one
+ *   message share its frame, so latency is measured from the oldest decode
+ *   not loaded yet.
+ * * jitter - deviation of the interval between two loads from the cycle of
+ *   a message, measured for cyclic only messages (COMM_TX_CYCLIC).
+ *
+ * Each message is counted in one histogram only, so one timestamp per
+ * message suffices. Bucket n of a histogram counts values below 2^n times
+ * its base, the last bucket all values above. A full bucket halves all
+ * buckets of its histogram, so the shape is kept and recent values weigh
+ * more. Read the histograms by comm_timing_get(), clear them by
+ * comm_timing_clear(), e.g. before and after a change.
+ *
+ * Like the probes of profile.h the histograms are compiled in with
+ * PROFILE_ENABLE only.
+ *
+ * \date Created: 16.10.2026 21:11:38
+ * \author agent
+ **/
+
+
+#ifndef COMM_TIMING_H_
+#define COMM_TIMING_H_
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \addtogroup comm_timing_definitions Latency and Jitter Histograms
+ * \brief definitions for the timing histograms of CAN2 messages
+ * @{
+ */
+
+/**
+ * \def COMM_TIMING_BUCKETS
+ * \brief number of buckets per histogram
+ */
+#define COMM_TIMING_BUCKETS         4
+
+/**
+ * \def COMM_TIMING_UNIT_SHIFT
+ * \brief timestamps are timebase_get() >> shift (64us, wraps after ~4.2s)
+ */
+#define COMM_TIMING_UNIT_SHIFT      2
+
+/**
+ * \def COMM_TIMING_LATENCY_BASE
+ * \brief log2 of first latency bucket in timestamp units (~2ms, last >= ~8ms)
+ *
+ * \def COMM_TIMING_JITTER_BASE
+ * \brief log2 of first jitter bucket in timestamp units (~1ms, last >= ~4ms)
+ */
+#define COMM_TIMING_LATENCY_BASE    5
+#define COMM_TIMING_JITTER_BASE     4
+
+/*! @} */
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief timing histograms of all CAN2 messages
+ */
+typedef struct
+{
+   //! latency from decoding a source to loading an event driven message
+   uint8_t latency[COMM_TIMING_BUCKETS];
+   //! deviation of the load interval of a cyclic message from its cycle
+   uint8_t jitter[COMM_TIMING_BUCKETS];
+} comm_timing_t;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+#ifdef PROFILE_ENABLE
+/**
+ * \brief forget pending timestamps, e.g. after wake up
+ * \param events - bits of event driven messages (COMM_TX_BIT_2_...), the
+ *                 other messages are cyclic only
+ *
+ * Histograms are kept.
+ */
+void comm_timing_init(uint8_t events);
+
+/**
+ * \brief timestamp the decode of a source message
+ * \param mask - bits of CAN2 messages depending on it (COMM_TX_BIT_2_...)
+ */
+void comm_timing_received(uint8_t mask);
+
+/**
+ * \brief count latency or jitter of a CAN2 message loaded for transmission
+ * \param index - index of message (order of COMM_MATRIX_TX_2)
+ * \param cycle - cycle of message (units of sched_getTime())
+ */
+void comm_timing_loaded(uint8_t index, uint16_t cycle);
+
+/**
+ * \brief clear all histograms
+ */
+void comm_timing_clear(void);
+
+/**
+ * \brief get timing histograms
+ * \return pointer to histograms
+ */
+comm_timing_t* comm_timing_get(void);
+#endif
+
+#endif /* COMM_TIMING_H_ */
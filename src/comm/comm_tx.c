@@ -0,0 +1,363 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file comm_tx.c
+ *
+ * \date Created: 16.10.2026 20:58:41
+ * \author agent
+ **/
+
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <string.h>
+
+#include "../modules/can/can_mcp2515.h"
+#include "../can_io/can_tx.h"
+#include "../can_io/mcp2515_spi.h"
+#include "../sched/scheduler.h"
+
+#include "comm_can_ids.h"
+#include "comm_matrix.h"
+#include "comm_matrix_gen.h"
+#include "comm_timing.h"
+#include "comm_tx.h"
+
+/***************************************************************************/
+/* VARIABLES                                                               */
+/***************************************************************************/
+
+//! transmit policies of CAN2 messages, see comm_matrix.mtx
+const comm_tx_t comm_txCan2[] PROGMEM =
+{
+   COMM_MATRIX_TX_2
+};
+
+//! number of CAN2 messages sent
+#define COMM_TX_NUM_OF_MSGS   ARRAY_SIZE(comm_txCan2)
+
+//! compilation fails, if a burst of all messages does not fit into the
+//! transmit buffers and the queue
+typedef char comm_txBurstFits[(COMM_TX_COUNT_2 <= CAN_TX_QUEUE_SIZE_CHIP2 +
+                               MCP_NUM_TX_BUFFERS) ? 1 : -1];
+
+//! transmit state of CAN2 messages, same order as comm_txCan2
+comm_tx_state_t comm_txState[COMM_TX_NUM_OF_MSGS];
+
+//! messages with changed sources (bit per message)
+uint8_t comm_txDirty = 0;
+
+//! messages with a stale cached frame (bit per message)
+uint8_t comm_txStale = 0;
+
+//! transmit statistics
+comm_tx_stats_t comm_txStats;
+
+/***************************************************************************/
+/* HELPERS                                                                 */
+/***************************************************************************/
+
+/**
+ * \brief increment a statistics counter without wrapping around
+ * \param counter - pointer to counter
+ */
+void comm_tx_increment(uint16_t* counter)
+{
+   if(UINT16_MAX != *counter)
+   {
+      ++(*counter);
+   }
+}
+
+#ifdef PROFILE_ENABLE
+/**
+ * \brief count the timing of a CAN2 message loaded into a transmit buffer
+ * \param msg - frame loaded
+ *
+ * Hook of can_tx_service(), see can_tx_setHook().
+ */
+void comm_tx_loaded(can_t* msg)
+{
+   uint8_t i;
+
+   for(i = 0; i < COMM_TX_NUM_OF_MSGS; ++i)
+   {
+      if(msg->msgId == comm_txState[i].frame.msgId)
+      {
+         comm_timing_loaded(i, pgm_read_word(&comm_txCan2[i].cycle));
+         return;
+      }
+   }
+}
+#endif
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief initialize transmission of CAN2 messages
+ *
+ * Staggers the cycles by COMM_TX_PHASE and marks all messages dirty and
+ * stale. Event driven messages are encoded and sent by the next
+ * comm_tx_run(). Cyclic only messages ignore the dirty bit, they are sent
+ * first when their staggered cycle is due ((index + 1) * COMM_TX_PHASE).
+ * Use comm_tx_burst() to send all at once. Call after can_tx_init() and
+ * after wake up.
+ */
+void comm_tx_init(void)
+{
+   uint16_t now = sched_getTime();
+   uint8_t  i;
+#ifdef PROFILE_ENABLE
+   uint8_t  events;
+#endif
+
+   memset(comm_txState, 0, sizeof(comm_txState));
+
+   for(i = 0; i < COMM_TX_NUM_OF_MSGS; ++i)
+   {
+      comm_txState[i].nextDue     = now + (i + 1) * COMM_TX_PHASE;
+      comm_txState[i].lastSent    = now - pgm_read_word(&comm_txCan2[i].gap);
+      comm_txState[i].frame.msgId = pgm_read_word(&comm_txCan2[i].msgId);
+   }
+
+   comm_txDirty = 0xFF;
+   comm_txStale = 0xFF;
+
+#ifdef PROFILE_ENABLE
+   events = 0;
+   for(i = 0; i < COMM_TX_NUM_OF_MSGS; ++i)
+   {
+      if(COMM_TX_CYCLIC != pgm_read_byte(&comm_txCan2[i].policy))
+      {
+         events |= (1 << i);
+      }
+   }
+   comm_timing_init(events);
+   can_tx_setHook(CAN_CHIP2, comm_tx_loaded);
+#endif
+}
+
+/**
+ * \brief mark messages dirty and their cache stale, since one of their
+ *        sources changed
+ * \param mask - bits of messages (COMM_TX_BIT_2_...)
+ *
+ * Main loop only.
+ */
+void comm_tx_markDirty(uint8_t mask)
+{
+   comm_txDirty |= mask;
+   comm_txStale |= mask;
+}
+
+/**
+ * \brief send all messages at once
+ * \return number of messages queued for transmission
+ *
+ * Each message is encoded from the values stored and queued, its cycle
+ * goes on one cycle later (staggered by COMM_TX_PHASE). Call after
+ * comm_tx_init(), e.g. after wake up.
+ */
+uint8_t comm_tx_burst(void)
+{
+   uint16_t         now   = sched_getTime();
+   uint8_t          sent  = 0;
+   comm_tx_state_t* state = comm_txState;
+   comm_tx_t        tx;
+   uint8_t          i;
+
+   for(i = 0; i < COMM_TX_NUM_OF_MSGS; ++i, ++state)
+   {
+      memcpy_P(&tx, &comm_txCan2[i], sizeof(tx));
+
+      fillInfoToCAN2(&state->frame);
+      comm_tx_increment(&comm_txStats.misses);
+
+      state->lastSent = now;
+      if(0 != tx.cycle)
+      {
+         state->nextDue = now + tx.cycle + (i + 1) * COMM_TX_PHASE;
+      }
+
+      if(true == can_tx_send(CAN_CHIP2, &state->frame, tx.prio,
+                             CAN_TX_CYCLIC,
+                             (0 != tx.cycle) ? tx.cycle
+                                             : COMM_TX_EVENT_LIFETIME))
+      {
+         ++sent;
+      }
+   }
+
+   // all sent with the values stored
+   comm_txDirty = 0;
+   comm_txStale = 0;
+   comm_tx_increment(&comm_txStats.bursts);
+
+   return sent;
+}
+
+/**
+ * \brief send all messages due by cycle or event
+ * \return number of messages queued for transmission
+ *
+ * A dirty message within its minimum gap stays dirty and is evaluated
+ * again in a later pass. Cyclic only messages ignore their dirty bit, but
+ * are encoded again, if their cache is stale.
+ *
+ * To be called every main loop pass.
+ */
+uint8_t comm_tx_run(void)
+{
+   uint16_t         now     = sched_getTime();
+   uint8_t          pending = comm_txDirty;
+   uint8_t          sent    = 0;
+   uint8_t          bit     = 1;
+   comm_tx_state_t* state   = comm_txState;
+   comm_tx_t        tx;
+   can_t            msg;
+   bool             due;
+   bool             event;
+   bool             changed;
+   uint8_t          i;
+
+   comm_txDirty = 0;
+
+   for(i = 0; i < COMM_TX_NUM_OF_MSGS; ++i, ++state, bit <<= 1)
+   {
+      memcpy_P(&tx, &comm_txCan2[i], sizeof(tx));
+
+      due   = (0 != tx.cycle) && ((int16_t)(now - state->nextDue) >= 0);
+      event = (COMM_TX_CYCLIC != tx.policy) && (0 != (pending & bit));
+
+      if((true == event) && ((uint16_t)(now - state->lastSent) < tx.gap))
+      {
+         // too early, try again later
+         comm_txDirty |= bit;
+         event = false;
+      }
+
+      if((false == due) && (false == event))
+      {
+         continue;
+      }
+
+      changed = false;
+      if(0 != (comm_txStale & bit))
+      {
+         comm_txStale &= ~bit;
+         comm_tx_increment(&comm_txStats.misses);
+
+         msg = state->frame;
+         fillInfoToCAN2(&msg);
+
+         changed = (msg.header.len != state->frame.header.len) ||
+                   (0 != memcmp(msg.data, state->frame.data,
+                                sizeof(msg.data)));
+         if(true == changed)
+         {
+            state->frame = msg;
+         }
+      }
+      else
+      {
+         comm_tx_increment(&comm_txStats.hits);
+      }
+
+      if((false == due) && (COMM_TX_ON_ARRIVAL != tx.policy) &&
+         (false == changed))
+      {
+         comm_tx_increment(&comm_txStats.unchanged);
+         continue;
+      }
+
+      comm_tx_increment((true == due) ? &comm_txStats.cyclic
+                                      : &comm_txStats.events);
+
+      state->lastSent = now;
+
+      if(0 != tx.cycle)
+      {
+         // keep the grid of the cycle, an event send restarts it
+         state->nextDue = (true == due) ? state->nextDue + tx.cycle
+                                        : now + tx.cycle;
+         if((int16_t)(now - state->nextDue) >= 0)
+         {
+            // fell behind, e.g. after wake up
+            state->nextDue = now + tx.cycle;
+         }
+      }
+
+      if(true == can_tx_send(CAN_CHIP2, &state->frame, tx.prio,
+                             CAN_TX_CYCLIC,
+                             (0 != tx.cycle) ? tx.cycle
+                                             : COMM_TX_EVENT_LIFETIME))
+      {
+         ++sent;
+      }
+   }
+
+   return sent;
+}
+
+/**
+ * \brief get time until the next send by cycle or minimum gap
+ * \return time in units of sched_getTime(), 0 if a send is due
+ *
+ * Valid after comm_tx_run(), e.g. to decide whether to sleep.
+ */
+uint16_t comm_tx_timeToNext(void)
+{
+   uint16_t         now   = sched_getTime();
+   int16_t          next  = INT16_MAX;
+   uint8_t          bit   = 1;
+   comm_tx_state_t* state = comm_txState;
+   const comm_tx_t* tx    = comm_txCan2;
+   uint16_t         cycle;
+   int16_t          left;
+   uint8_t          i;
+
+   for(i = 0; i < COMM_TX_NUM_OF_MSGS; ++i, ++state, ++tx, bit <<= 1)
+   {
+      cycle = pgm_read_word(&tx->cycle);
+      if(0 != cycle)
+      {
+         left = (int16_t)(state->nextDue - now);
+         if(left < next)
+         {
+            next = left;
+         }
+      }
+      // event waiting for its minimum gap
+      if(0 != (comm_txDirty & bit))
+      {
+         left = (int16_t)(state->lastSent + pgm_read_word(&tx->gap) - now);
+         if(left < next)
+         {
+            next = left;
+         }
+      }
+   }
+
+   return (next < 0) ? 0 : (uint16_t)next;
+}
+
+/**
+ * \brief get transmit statistics of CAN2 messages
+ * \return pointer to statistics
+ */
+comm_tx_stats_t* comm_tx_getStats(void)
+{
+   return &comm_txStats;
+}
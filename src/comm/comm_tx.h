@@ -0,0 +1,208 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file comm_tx.h
+ *
+ * Transmission of CAN2 messages by their policy in comm_matrix.mtx:
+ *
+ * * cyclic            - sent by its cycle only
+ * * change            - sent, if its content changed
+ * * arrival           - sent, if a source message arrived
+ * * cyclic+change     - sent by its cycle and at once, if its content changed
+ *
+ * Decoding a CAN1 message marks the messages depending on it dirty (see
+ * the dirty masks of CANID_1_CONSUMED). comm_tx_run() encodes a dirty
+ * message, compares it to the payload sent last and sends it, if it
+ * changed. The minimum gap bounds the bus load of event driven sends, an
+ * event send restarts the cycle. So a gear change reaches CAN2 within one
+ * main loop pass, instead of waiting for the next 500ms slot, and the
+ * average bus load stays the same as long as signals do not change faster
+ * than their cycle.
+ *
+ * The encoded frame of each message is cached. It is encoded again only,
+ * if a source message was decoded since (stale), otherwise the cached frame
+ * is queued as is. So the sources of a message in comm_matrix.mtx need to
+ * name every message its encoder reads values of. Cost (atmega8, -Os,
+ * estimated): encoding takes ~150 cycles for fillVehConfig up to ~900
+ * cycles for fillWheelData (dispatch, snapshot of the store, signals), a
+ * cache hit ~10 cycles, since can_tx_send() copies the frame anyway. See
+ * comm_tx_stats_t::hits and comm_tx_stats_t::misses.
+ *
+ * After wake up comm_tx_burst() sends every message at once from the
+ * values stored before sleep, so the radio gets its full state without
+ * waiting for the cycles (up to 2s for the vehicle configuration).
+ *
+ * \date Created: 16.10.2026 20:58:41
+ * \author agent
+ **/
+
+
+#ifndef COMM_TX_H_
+#define COMM_TX_H_
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \addtogroup comm_tx_definitions Transmit Policies
+ * \brief definitions for sending CAN2 messages by policy
+ * @{
+ */
+
+/**
+ * \def COMM_TX_PHASE
+ * \brief offset between the first cyclic sends of two messages
+ *
+ * Spreads the cycles over different main loop passes.
+ */
+#define COMM_TX_PHASE               SCHED_MS2TIME(10)
+
+/**
+ * \def COMM_TX_EVENT_LIFETIME
+ * \brief lifetime of messages without cycle (units of sched_getTime())
+ */
+#define COMM_TX_EVENT_LIFETIME      SCHED_MS2TIME(100)
+
+/*! @} */
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief when to send a message
+ */
+typedef enum
+{
+   //! sent by its cycle only
+   COMM_TX_CYCLIC           = 0,
+   //! sent, if its content changed (not before minimum gap)
+   COMM_TX_ON_CHANGE        = 1,
+   //! sent, if a source message arrived (not before minimum gap)
+   COMM_TX_ON_ARRIVAL       = 2,
+   //! sent by its cycle and at once, if its content changed
+   COMM_TX_CYCLIC_ON_CHANGE = 3
+} comm_tx_policy_t;
+
+/**
+ * \brief transmit policy of a message (flash, see COMM_MATRIX_TX_2)
+ *
+ * Times are in units of sched_getTime().
+ */
+typedef struct
+{
+   //! CAN id
+   uint16_t         msgId;
+   //! when to send
+   comm_tx_policy_t policy;
+   //! importance of message
+   can_tx_prio_t    prio;
+   //! cycle (0 - none)
+   uint16_t         cycle;
+   //! minimum gap between event driven sends
+   uint16_t         gap;
+} comm_tx_t;
+
+/**
+ * \brief transmit state of a message
+ */
+typedef struct
+{
+   //! time of next cyclic send
+   uint16_t nextDue;
+   //! time of last send
+   uint16_t lastSent;
+   //! frame encoded last (cache)
+   can_t    frame;
+} comm_tx_state_t;
+
+/**
+ * \brief transmit statistics of CAN2 messages
+ *
+ * Counters saturate instead of wrapping around.
+ */
+typedef struct
+{
+   //! messages sent by their cycle
+   uint16_t cyclic;
+   //! messages sent by an event
+   uint16_t events;
+   //! events without send, since the content did not change
+   uint16_t unchanged;
+   //! frames taken from the cache
+   uint16_t hits;
+   //! frames encoded, since their sources changed
+   uint16_t misses;
+   //! bursts of all messages, e.g. after wake up
+   uint16_t bursts;
+} comm_tx_stats_t;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief initialize transmission of CAN2 messages
+ *
+ * Staggers the cycles by COMM_TX_PHASE and marks all messages dirty and
+ * stale. Event driven messages are encoded and sent by the next
+ * comm_tx_run(). Cyclic only messages ignore the dirty bit, they are sent
+ * first when their staggered cycle is due ((index + 1) * COMM_TX_PHASE).
+ * Use comm_tx_burst() to send all at once. Call after can_tx_init() and
+ * after wake up.
+ */
+void comm_tx_init(void);
+
+/**
+ * \brief mark messages dirty and their cache stale, since one of their
+ *        sources changed
+ * \param mask - bits of messages (COMM_TX_BIT_2_...)
+ *
+ * Main loop only.
+ */
+void comm_tx_markDirty(uint8_t mask);
+
+/**
+ * \brief send all messages at once
+ * \return number of messages queued for transmission
+ *
+ * Each message is encoded from the values stored and queued, its cycle
+ * goes on one cycle later (staggered by COMM_TX_PHASE). Call after
+ * comm_tx_init(), e.g. after wake up.
+ */
+uint8_t comm_tx_burst(void);
+
+/**
+ * \brief send all messages due by cycle or event
+ * \return number of messages queued for transmission
+ *
+ * To be called every main loop pass.
+ */
+uint8_t comm_tx_run(void);
+
+/**
+ * \brief get time until the next send by cycle or minimum gap
+ * \return time in units of sched_getTime(), 0 if a send is due
+ *
+ * Valid after comm_tx_run(), e.g. to decide whether to sleep.
+ */
+uint16_t comm_tx_timeToNext(void);
+
+/**
+ * \brief get transmit statistics of CAN2 messages
+ * \return pointer to statistics
+ */
+comm_tx_stats_t* comm_tx_getStats(void);
+
+#endif /* COMM_TX_H_ */
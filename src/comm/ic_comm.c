@@ -20,6 +20,8 @@
  */
 
 #include "../modules/can/can_mcp2515.h"
+#include "../sched/scheduler.h"
+#include "../can_io/can_tx.h"
 
 #include "comm_can_ids.h"
 #include "ic_comm.h"
@@ -402,10 +404,9 @@ void ic_comm_fsm(can_t* msg)
  */
 void ic_comm_send2Cluster(can_t* msg)
 {
-   while(0 == can_send_message(CAN_CHIP1, msg))
-   {
-      _delay_us(10);
-   }
+   // frames of the communication sequence must keep their order
+   can_tx_send(CAN_CHIP1, msg, CAN_TX_PRIO_HIGH, CAN_TX_SEQUENCE,
+               CAN_TX_LIFETIME_DEFAULT);
 }
 
 /**
@@ -0,0 +1,133 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file idle.c
+ *
+ * \date Created: 16.10.2026 21:15:10
+ * \author agent
+ **/
+
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <stdbool.h>
+
+#include "scheduler.h"
+#include "timebase.h"
+#include "idle.h"
+
+/***************************************************************************/
+/* VARIABLES                                                               */
+/***************************************************************************/
+
+//! CPU is in an idle period, cleared by idle_wake()
+volatile bool idle_asleep = false;
+
+//! time of the wake up interrupt (lower 16bit of timebase_get())
+volatile uint16_t idle_wokenAt = 0;
+
+//! time spent idle since last sample
+uint32_t idle_time = 0;
+
+//! time of last sample
+uint32_t idle_lastSample = 0;
+
+//! idle statistics
+idle_stats_t idle_stats;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief sleep in idle mode until the next interrupt
+ *
+ * Call with interrupts disabled after checking for pending work, so no
+ * interrupt gets lost in between. Returns with interrupts enabled.
+ */
+void idle_sleep(void)
+{
+   uint16_t start = (uint16_t)timebase_get();
+   uint16_t end;
+   uint16_t latency;
+
+   idle_asleep = true;
+
+   set_sleep_mode(SLEEP_MODE_IDLE);
+   sleep_enable();
+   // the instruction after sei() is executed before any interrupt
+   sei();
+   sleep_cpu();
+   sleep_disable();
+
+   end        = (uint16_t)timebase_get();
+   idle_time += (uint16_t)(end - start);
+
+   if(false == idle_asleep)
+   {
+      latency = end - idle_wokenAt;
+      idle_stats.latencyLast = latency;
+      if(latency > idle_stats.latencyMax)
+      {
+         idle_stats.latencyMax = latency;
+      }
+      if(UINT16_MAX != idle_stats.wakeups)
+      {
+         ++idle_stats.wakeups;
+      }
+   }
+   idle_asleep = false;
+}
+
+/**
+ * \brief mark the end of an idle period
+ *
+ * To be called first thing by the wake up interrupts.
+ */
+void idle_wake(void)
+{
+   if(true == idle_asleep)
+   {
+      idle_wokenAt = (uint16_t)timebase_get();
+      idle_asleep  = false;
+   }
+}
+
+/**
+ * \brief sample the share of time spent idle
+ *
+ * Periodic job of IDLE_SAMPLE_PERIOD_MS.
+ */
+void idle_sample(void)
+{
+   uint32_t now     = timebase_get();
+   uint32_t elapsed = now - idle_lastSample;
+
+   if(0 != elapsed)
+   {
+      idle_stats.share = (uint16_t)(idle_time * 1000 / elapsed);
+   }
+
+   idle_time       = 0;
+   idle_lastSample = now;
+}
+
+/**
+ * \brief get idle statistics
+ * \return pointer to statistics
+ */
+idle_stats_t* idle_getStats(void)
+{
+   return &idle_stats;
+}
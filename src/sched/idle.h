@@ -0,0 +1,116 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file idle.h
+ *
+ * AVR idle mode between main loop passes. The CPU stops until the next
+ * interrupt, timers, SPI and external interrupts keep running. Wake up
+ * sources are the INT pins of the MCP2515 (INT0/INT1), the scheduler tick
+ * (Timer2) and the timebase overflow (Timer0), which bounds an idle period
+ * to IDLE_MAX_TIME.
+ *
+ * The wake up interrupts call idle_wake(), so the time from waking up to
+ * the main loop going on (wake-to-work latency, including the interrupt
+ * itself) is measured. idle_sample() turns the time spent idle into a
+ * share per period.
+ *
+ * \date Created: 16.10.2026 21:15:10
+ * \author agent
+ **/
+
+
+#ifndef IDLE_H_
+#define IDLE_H_
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \addtogroup idle_definitions Idle Mode
+ * \brief definitions for sleeping between main loop passes
+ * @{
+ */
+
+/**
+ * \def IDLE_MAX_TIME
+ * \brief longest idle period in units of sched_getTime() (Timer0 overflow)
+ *
+ * Work due earlier is better polled for than slept on.
+ */
+#define IDLE_MAX_TIME               ((uint16_t)(256UL * TIMEBASE_UNIT_US / \
+                                                SCHED_TIME_UNIT_US) + 1)
+
+/**
+ * \def IDLE_SAMPLE_PERIOD_MS
+ * \brief period of idle_sample() in ms
+ */
+#define IDLE_SAMPLE_PERIOD_MS       1000
+
+/*! @} */
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief idle statistics
+ *
+ * Counters saturate instead of wrapping around. Times are in units of
+ * timebase_get().
+ */
+typedef struct
+{
+   //! time spent idle during the last IDLE_SAMPLE_PERIOD_MS in per mille
+   uint16_t share;
+   //! idle periods ended by a wake up interrupt calling idle_wake()
+   uint16_t wakeups;
+   //! last time from wake up interrupt to main loop
+   uint16_t latencyLast;
+   //! longest time from wake up interrupt to main loop
+   uint16_t latencyMax;
+} idle_stats_t;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief sleep in idle mode until the next interrupt
+ *
+ * Call with interrupts disabled after checking for pending work, so no
+ * interrupt gets lost in between. Returns with interrupts enabled.
+ */
+void idle_sleep(void);
+
+/**
+ * \brief mark the end of an idle period
+ *
+ * To be called first thing by the wake up interrupts.
+ */
+void idle_wake(void);
+
+/**
+ * \brief sample the share of time spent idle
+ *
+ * Periodic job of IDLE_SAMPLE_PERIOD_MS.
+ */
+void idle_sample(void);
+
+/**
+ * \brief get idle statistics
+ * \return pointer to statistics
+ */
+idle_stats_t* idle_getStats(void);
+
+#endif /* IDLE_H_ */
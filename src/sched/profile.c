@@ -0,0 +1,96 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file profile.c
+ *
+ * \date Created: 16.10.2026 21:12:38
+ * \author agent
+ **/
+
+
+#include <avr/io.h>
+#include <string.h>
+
+#include "profile.h"
+
+#ifdef PROFILE_ENABLE
+
+/***************************************************************************/
+/* VARIABLES                                                               */
+/***************************************************************************/
+
+//! records of all probes
+profile_entry_t profile_table[PROFILE_NUM_OF_PROBES];
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief start Timer1 as free running cycle counter of the probes
+ */
+void profile_init(void)
+{
+   // normal mode, no interrupts, the probes read TCNT1 only
+   TCCR1A = 0;
+   TCCR1B = PROFILE_PRESCALER;
+}
+
+/**
+ * \brief record the run time of a probe
+ * \param id - probe
+ * \param start - Timer1 count at PROFILE_BEGIN()
+ *
+ * Use PROFILE_END() instead.
+ */
+void profile_record(profile_id_t id, uint16_t start)
+{
+   profile_entry_t* entry = &profile_table[id];
+   uint16_t         time  = TCNT1 - start;
+
+   if(UINT16_MAX == entry->calls)
+   {
+      return;
+   }
+
+   if((0 == entry->calls) || (time < entry->min))
+   {
+      entry->min = time;
+   }
+   if(time > entry->max)
+   {
+      entry->max = time;
+   }
+   entry->sum += time;
+   ++entry->calls;
+}
+
+/**
+ * \brief clear records of all probes
+ */
+void profile_clear(void)
+{
+   memset(profile_table, 0, sizeof(profile_table));
+}
+
+/**
+ * \brief get record of a probe
+ * \param id - probe
+ * \return pointer to record
+ */
+profile_entry_t* profile_get(profile_id_t id)
+{
+   return &profile_table[id];
+}
+
+#endif
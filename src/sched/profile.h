@@ -0,0 +1,154 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file profile.h
+ *
+ * Cycle profiler for the main loop. A probe is a pair of PROFILE_BEGIN()
+ * and PROFILE_END() around the code to measure:
+ * \code
+ * PROFILE_BEGIN(PROFILE_FETCH_CAN1);
+ * ...
+ * PROFILE_END(PROFILE_FETCH_CAN1);
+ * \endcode
+ * Each probe keeps its number of calls and minimum, maximum and sum of its
+ * run time. Times are CPU cycles, counted by Timer1 running free at
+ * prescaler 1 (unused since the bus sleep detection left it, see
+ * comm_sleep.h). A probe costs ~50 cycles. Nested probes include the inner
+ * ones. Timer1 wraps every 65536 cycles (~16ms at 4MHz) without interrupt,
+ * so a longer run is recorded modulo 65536 cycles.
+ *
+ * The probes are compiled in with PROFILE_ENABLE only. The top level
+ * CMakeLists.txt defines it for all build types but Release, so a release
+ * build has neither code nor RAM for them and leaves Timer1 stopped.
+ *
+ * \date Created: 16.10.2026 21:12:38
+ * \author agent
+ **/
+
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \addtogroup profile_definitions Cycle Profiler
+ * \brief definitions for profiling probes
+ * @{
+ */
+
+/**
+ * \def PROFILE_PRESCALER
+ * \brief Timer1 prescaler settings (clkI/O/1, one unit per CPU cycle)
+ */
+#define PROFILE_PRESCALER           (1 << CS10)
+
+/**
+ * \def PROFILE_BEGIN
+ * \brief start a probe
+ * \param id - probe (profile_id_t)
+ *
+ * \def PROFILE_END
+ * \brief stop a probe and record its run time
+ * \param id - probe (profile_id_t), same scope as its PROFILE_BEGIN()
+ */
+#ifdef PROFILE_ENABLE
+#define PROFILE_BEGIN(id)           uint16_t profile_start_##id = TCNT1
+#define PROFILE_END(id)             profile_record((id), profile_start_##id)
+#else
+#define PROFILE_BEGIN(id)           do {} while(0)
+#define PROFILE_END(id)             do {} while(0)
+#endif
+
+/*! @} */
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief probes of the main loop
+ */
+typedef enum
+{
+   //! handleCan1Reception()
+   PROFILE_CAN1_RECEPTION    = 0,
+   //! handleCan2Transmission(), including the periodic jobs
+   PROFILE_CAN2_TRANSMISSION = 1,
+   //! handleCan2Reception()
+   PROFILE_CAN2_RECEPTION    = 2,
+   //! fetchInfoFromCAN1()
+   PROFILE_FETCH_CAN1        = 3,
+   //! fillInfoToCAN2()
+   PROFILE_FILL_CAN2         = 4,
+   //! setDimValue()
+   PROFILE_SET_DIM           = 5,
+   //! checkCanStatus(), the error polling of both CAN chips
+   PROFILE_CAN_STATUS        = 6,
+   //! number of probes
+   PROFILE_NUM_OF_PROBES     = 7
+} profile_id_t;
+
+/**
+ * \brief record of a probe
+ *
+ * Times are in CPU cycles, mean = sum / calls. Recording stops, when
+ * calls saturate.
+ */
+typedef struct
+{
+   //! number of calls
+   uint16_t calls;
+   //! shortest run time
+   uint16_t min;
+   //! longest run time
+   uint16_t max;
+   //! sum of all run times
+   uint32_t sum;
+} profile_entry_t;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+#ifdef PROFILE_ENABLE
+/**
+ * \brief start Timer1 as free running cycle counter of the probes
+ */
+void profile_init(void);
+
+/**
+ * \brief record the run time of a probe
+ * \param id - probe
+ * \param start - Timer1 count at PROFILE_BEGIN()
+ *
+ * Use PROFILE_END() instead.
+ */
+void profile_record(profile_id_t id, uint16_t start);
+
+/**
+ * \brief clear records of all probes
+ */
+void profile_clear(void);
+
+/**
+ * \brief get record of a probe
+ * \param id - probe
+ * \return pointer to record
+ */
+profile_entry_t* profile_get(profile_id_t id);
+#endif
+
+#endif /* PROFILE_H_ */
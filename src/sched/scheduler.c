@@ -0,0 +1,217 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file scheduler.c
+ *
+ * \date Created: 16.10.2026 20:34:32
+ * \author agent
+ **/
+
+
+#include <avr/io.h>
+#include <util/atomic.h>
+#include <stdbool.h>
+
+#include "config/timer_config.h"
+
+#include "scheduler.h"
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief entry of a registered job
+ */
+typedef struct
+{
+   //! function to call
+   sched_job_t job;
+   //! absolute tick of next call
+   uint32_t    due;
+   //! period in ticks
+   uint16_t    period;
+   //! next job in the same wheel slot
+   uint8_t     next;
+} sched_entry_t;
+
+/***************************************************************************/
+/* VARIABLES                                                               */
+/***************************************************************************/
+
+//! monotonic tick counter (Timer2)
+volatile uint32_t sched_ticks = 0;
+
+//! last tick processed by sched_run()
+uint32_t sched_lastRun = 0;
+
+//! registered jobs
+sched_entry_t sched_jobs[SCHED_MAX_JOBS];
+
+//! number of registered jobs
+uint8_t sched_numJobs = 0;
+
+//! first job of each slot
+uint8_t sched_wheel[SCHED_WHEEL_SIZE] =
+{
+   SCHED_NO_JOB, SCHED_NO_JOB, SCHED_NO_JOB, SCHED_NO_JOB,
+   SCHED_NO_JOB, SCHED_NO_JOB, SCHED_NO_JOB, SCHED_NO_JOB
+};
+
+/***************************************************************************/
+/* HELPERS                                                                 */
+/***************************************************************************/
+
+/**
+ * \brief put job into wheel slot of its due tick
+ * \param id - job id
+ */
+void sched_insert(uint8_t id)
+{
+   uint8_t slot = sched_jobs[id].due & (SCHED_WHEEL_SIZE - 1);
+
+   sched_jobs[id].next = sched_wheel[slot];
+   sched_wheel[slot]   = id;
+}
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief register a periodic job
+ * \param job - function to call
+ * \param period - period in ticks (> 0)
+ * \param phase - offset in ticks to first call (< period)
+ * \return job id or SCHED_NO_JOB, if no job is left
+ */
+uint8_t sched_register(sched_job_t job, uint16_t period, uint16_t phase)
+{
+   uint8_t id = SCHED_NO_JOB;
+
+   if((sched_numJobs < SCHED_MAX_JOBS) && (0 != period))
+   {
+      id = sched_numJobs++;
+      sched_jobs[id].job    = job;
+      sched_jobs[id].period = period;
+      sched_jobs[id].due    = sched_lastRun + 1 + (phase % period);
+      sched_insert(id);
+   }
+
+   return id;
+}
+
+/**
+ * \brief advance tick counter
+ *
+ * To be called by the timer interrupt only.
+ */
+void sched_tick(void)
+{
+   ++sched_ticks;
+}
+
+/**
+ * \brief get current tick count
+ * \return ticks since start
+ */
+uint32_t sched_getTicks(void)
+{
+   uint32_t ticks;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      ticks = sched_ticks;
+   }
+
+   return ticks;
+}
+
+/**
+ * \brief get fine grained time for measuring short intervals
+ * \return time in units of SCHED_TIME_UNIT_US (wraps after ~16.7s)
+ *
+ * Combines the tick count with the Timer2 counter value.
+ */
+uint16_t sched_getTime(void)
+{
+   uint16_t ticks;
+   uint8_t  count;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      ticks = (uint16_t)sched_ticks;
+      count = TCNT2;
+      // compare match happened, but tick is not counted yet
+      if((TIFR & (1 << OCF2)) && (count < (TIMER2_COMPARE_VALUE / 2)))
+      {
+         ++ticks;
+      }
+   }
+
+   return ticks * (TIMER2_COMPARE_VALUE + 1) + count;
+}
+
+/**
+ * \brief run all jobs due since last call
+ * \return number of jobs run
+ *
+ * Every tick elapsed is processed, so a late main loop pass only delays
+ * jobs but never shifts their phase.
+ */
+uint8_t sched_run(void)
+{
+   uint32_t now = sched_getTicks();
+   uint8_t  count = 0;
+   uint8_t  id;
+   uint8_t  next;
+   uint8_t  slot;
+
+   while(sched_lastRun != now)
+   {
+      ++sched_lastRun;
+      slot = sched_lastRun & (SCHED_WHEEL_SIZE - 1);
+
+      // detach slot, any job is put back according to its due tick
+      id = sched_wheel[slot];
+      sched_wheel[slot] = SCHED_NO_JOB;
+
+      while(SCHED_NO_JOB != id)
+      {
+         next = sched_jobs[id].next;
+
+         if(sched_jobs[id].due == sched_lastRun)
+         {
+            sched_jobs[id].job();
+            sched_jobs[id].due += sched_jobs[id].period;
+            ++count;
+         }
+
+         sched_insert(id);
+         id = next;
+      }
+   }
+
+   return count;
+}
+
+/**
+ * \brief check for ticks not processed by sched_run() yet
+ * \return true, if sched_run() has work
+ *
+ * E.g. to decide whether to sleep until the next interrupt.
+ */
+bool sched_isPending(void)
+{
+   return (sched_lastRun != sched_getTicks());
+}
@@ -0,0 +1,144 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file scheduler.h
+ *
+ * Timer wheel for all periodic work. The Timer2 compare interrupt only
+ * increments a monotonic 32bit tick. The main loop runs all jobs due since
+ * its last call. Each job has a period and a phase offset in ticks, so the
+ * cycles keep their phase and can be spread over different ticks.
+ *
+ * \date Created: 16.10.2026 20:34:32
+ * \author agent
+ **/
+
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \addtogroup sched_definitions Timer Wheel Scheduler
+ * \brief definitions for periodic jobs
+ * @{
+ */
+
+/**
+ * \def SCHED_TICK_MS
+ * \brief duration of one tick in ms (Timer2 compare match)
+ * \sa TIMER2_COMPARE_VALUE
+ */
+#define SCHED_TICK_MS         25
+
+/**
+ * \def SCHED_MS2TICKS
+ * \brief convert milliseconds to ticks
+ */
+#define SCHED_MS2TICKS(ms)    ((ms) / SCHED_TICK_MS)
+
+/**
+ * \def SCHED_TIME_UNIT_US
+ * \brief resolution of sched_getTime() in us (4MHz@1024 prescale factor)
+ */
+#define SCHED_TIME_UNIT_US    256
+
+/**
+ * \def SCHED_MS2TIME
+ * \brief convert milliseconds to units of sched_getTime()
+ */
+#define SCHED_MS2TIME(ms)     ((uint16_t)((ms) * 1000UL / SCHED_TIME_UNIT_US))
+
+/**
+ * \def SCHED_MAX_JOBS
+ * \brief maximum number of jobs to register
+ */
+#define SCHED_MAX_JOBS        8
+
+/**
+ * \def SCHED_WHEEL_SIZE
+ * \brief number of slots in the timer wheel (power of 2)
+ *
+ * A job is only looked at in the tick matching its slot. Jobs with a
+ * period longer than the wheel stay in their slot until they are due.
+ */
+#define SCHED_WHEEL_SIZE      8
+
+/**
+ * \def SCHED_NO_JOB
+ * \brief invalid job id, e.g. all jobs in use
+ */
+#define SCHED_NO_JOB          0xFF
+
+/*! @} */
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief periodic job to run
+ */
+typedef void (*sched_job_t)(void);
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief register a periodic job
+ * \param job - function to call
+ * \param period - period in ticks (> 0)
+ * \param phase - offset in ticks to first call (< period)
+ * \return job id or SCHED_NO_JOB, if no job is left
+ */
+uint8_t sched_register(sched_job_t job, uint16_t period, uint16_t phase);
+
+/**
+ * \brief advance tick counter
+ *
+ * To be called by the timer interrupt only.
+ */
+void sched_tick(void);
+
+/**
+ * \brief get current tick count
+ * \return ticks since start
+ */
+uint32_t sched_getTicks(void);
+
+/**
+ * \brief get fine grained time for measuring short intervals
+ * \return time in units of SCHED_TIME_UNIT_US (wraps after ~16.7s)
+ *
+ * Combines the tick count with the Timer2 counter value.
+ */
+uint16_t sched_getTime(void);
+
+/**
+ * \brief run all jobs due since last call
+ * \return number of jobs run
+ */
+uint8_t sched_run(void);
+
+/**
+ * \brief check for ticks not processed by sched_run() yet
+ * \return true, if sched_run() has work
+ *
+ * E.g. to decide whether to sleep until the next interrupt.
+ */
+bool sched_isPending(void);
+
+#endif /* SCHEDULER_H_ */
@@ -0,0 +1,83 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file timebase.c
+ *
+ * \date Created: 16.10.2026 21:11:38
+ * \author agent
+ **/
+
+
+#include <avr/io.h>
+#include <util/atomic.h>
+
+#include "timebase.h"
+
+/***************************************************************************/
+/* VARIABLES                                                               */
+/***************************************************************************/
+
+//! overflows of Timer0 (upper 24bit of time)
+volatile uint32_t timebase_overflows = 0;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief start Timer0 as free running timebase
+ *
+ * Enables the overflow interrupt, which needs to call timebase_overflow().
+ */
+void timebase_init(void)
+{
+   TCNT0  = 0;
+   TIFR   = (1 << TOV0);
+   TIMSK |= (1 << TOIE0);
+   TCCR0  = TIMEBASE_PRESCALER;
+}
+
+/**
+ * \brief extend the count of Timer0
+ *
+ * To be called by the Timer0 overflow interrupt only.
+ */
+void timebase_overflow(void)
+{
+   ++timebase_overflows;
+}
+
+/**
+ * \brief get current time
+ * \return time in units of TIMEBASE_UNIT_US (wraps after ~19h)
+ *
+ * Works with interrupts disabled for less than one overflow (~4ms), too.
+ */
+uint32_t timebase_get(void)
+{
+   uint32_t overflows;
+   uint8_t  count;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      overflows = timebase_overflows;
+      count     = TCNT0;
+      // overflow happened, but is not counted yet
+      if((TIFR & (1 << TOV0)) && (count < 0x80))
+      {
+         ++overflows;
+      }
+   }
+
+   return (overflows << 8) | count;
+}
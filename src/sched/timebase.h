@@ -0,0 +1,91 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file timebase.h
+ *
+ * Free running timebase for timestamps. Timer0 counts at clkI/O/64 (16us
+ * at 4MHz), its overflow interrupt (every ~4ms) extends the count to 32bit.
+ * So short intervals are measured ~16 times finer than by sched_getTime()
+ * and long ones do not wrap for hours. The overflow interrupt costs ~40
+ * cycles every 1024 cycles * 4, i.e. ~0.1% of the CPU.
+ *
+ * Timer0 stops in power down, so the timebase pauses while sleeping.
+ *
+ * \date Created: 16.10.2026 21:11:38
+ * \author agent
+ **/
+
+
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \addtogroup timebase_definitions Free Running Timebase
+ * \brief definitions for timestamps by Timer0
+ * @{
+ */
+
+/**
+ * \def TIMEBASE_PRESCALER
+ * \brief Timer0 prescaler settings (clkI/O/64)
+ *
+ * Timer0 is owned by this module, so TIMER0_PRESCALER of timer_config.h
+ * stays unset.
+ */
+#define TIMEBASE_PRESCALER    ((1 << CS01) | (1 << CS00))
+
+/**
+ * \def TIMEBASE_UNIT_US
+ * \brief resolution of timebase_get() in us
+ */
+#define TIMEBASE_UNIT_US      (64 * 1000000UL / F_CPU)
+
+/**
+ * \def TIMEBASE_US2TICKS
+ * \brief convert microseconds to units of timebase_get()
+ */
+#define TIMEBASE_US2TICKS(us) ((uint32_t)(us) / TIMEBASE_UNIT_US)
+
+/*! @} */
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief start Timer0 as free running timebase
+ *
+ * Enables the overflow interrupt, which needs to call timebase_overflow().
+ */
+void timebase_init(void);
+
+/**
+ * \brief extend the count of Timer0
+ *
+ * To be called by the Timer0 overflow interrupt only.
+ */
+void timebase_overflow(void);
+
+/**
+ * \brief get current time
+ * \return time in units of TIMEBASE_UNIT_US (wraps after ~19h)
+ *
+ * Works with interrupts disabled for less than one overflow (~4ms), too.
+ */
+uint32_t timebase_get(void);
+
+#endif /* TIMEBASE_H_ */
@@ -0,0 +1,209 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file main.cpp
+ *
+ * Matrix compiler: reads the description of the CAN matrix (see
+ * src/comm/comm_matrix.mtx), checks it and generates the C headers
+ * comm_matrix_gen.h and can_filter_config.h and an EEPROM image of the
+ * routed signals.
+ *
+ * \code
+ * matrix_compiler [-ids file.h] [-header file.h] [-filters file.h]
+ *                 [-blob file.bin] [-revision n] [-report] description.mtx
+ * \endcode
+ *
+ * The ids are defined in comm_can_ids.h only, the generated header includes
+ * it. The ids of the description are checked against it (option -ids),
+ * which is needed to write the headers.
+ *
+ * \date Created: 16.10.2026 20:50:57
+ * \author agent
+ **/
+
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include "matrix.h"
+#include "output.h"
+
+/***************************************************************************/
+/* HELPERS                                                                 */
+/***************************************************************************/
+
+/**
+ * \brief print usage
+ * \param name - name of program
+ */
+static void usagePrint(const char* name)
+{
+   std::cerr << "usage: " << name
+             << " [option(s)] description.mtx\n\n"
+             << "   -ids file.h       - check ids against CANID_x_<name>\n"
+             << "   -header file.h    - write C header\n"
+             << "   -filters file.h   - write acceptance filters of MCP2515\n"
+             << "   -blob file.bin    - write EEPROM image\n"
+             << "   -revision n       - revision of EEPROM image (0..65535)\n"
+             << "   -report           - print estimated cycles per message\n"
+             << "   -help             - show this help\n";
+}
+
+/***************************************************************************/
+/* MAIN                                                                    */
+/***************************************************************************/
+
+/**
+ * \brief main function of matrix compiler
+ * \param argc - number of arguments
+ * \param argv - arguments
+ * \return 0 on success, 1 on errors
+ */
+int main(int argc, char* argv[])
+{
+   std::string inFile;
+   std::string idFile;
+   std::string headerFile;
+   std::string filterFile;
+   std::string blobFile;
+   unsigned    revision = 0;
+   bool        report   = false;
+
+   // get arguments
+   for(int i = 1; i < argc; ++i)
+   {
+      std::string arg = argv[i];
+
+      if("-help" == arg)
+      {
+         usagePrint(argv[0]);
+         return 0;
+      }
+      else if(("-ids" == arg) && (i + 1 < argc))
+      {
+         idFile = argv[++i];
+      }
+      else if(("-header" == arg) && (i + 1 < argc))
+      {
+         headerFile = argv[++i];
+      }
+      else if(("-filters" == arg) && (i + 1 < argc))
+      {
+         filterFile = argv[++i];
+      }
+      else if(("-blob" == arg) && (i + 1 < argc))
+      {
+         blobFile = argv[++i];
+      }
+      else if(("-revision" == arg) && (i + 1 < argc))
+      {
+         revision = std::strtoul(argv[++i], 0, 0);
+      }
+      else if("-report" == arg)
+      {
+         report = true;
+      }
+      else if(inFile.empty() && ('-' != arg[0]))
+      {
+         inFile = arg;
+      }
+      else
+      {
+         usagePrint(argv[0]);
+         return 1;
+      }
+   }
+
+   // no filename given, headers use the ids of an unchecked id file
+   if(inFile.empty() || (revision > 0xFFFF) ||
+      (idFile.empty() && (!headerFile.empty() || !filterFile.empty())))
+   {
+      usagePrint(argv[0]);
+      return 1;
+   }
+
+   try
+   {
+      std::ifstream in(inFile.c_str());
+      if(!in)
+      {
+         throw matrix::Error(inFile, 0, "could not open");
+      }
+
+      matrix::Description      description = matrix::parse(in, inFile);
+      std::vector<std::string> warnings    = matrix::validate(description);
+
+      for(size_t i = 0; i < warnings.size(); ++i)
+      {
+         std::cerr << warnings[i] << "\n";
+      }
+
+      if(!idFile.empty())
+      {
+         std::ifstream ids(idFile.c_str());
+         if(!ids)
+         {
+            throw matrix::Error(idFile, 0, "could not open");
+         }
+         matrix::checkIds(description, ids, idFile);
+      }
+
+      std::cout << description.messages.size() << " messages, "
+                << description.routes.size() << " routed signals\n";
+
+      if(!headerFile.empty())
+      {
+         std::ofstream out(headerFile.c_str());
+         matrix::writeHeader(out, description);
+         if(!out)
+         {
+            throw matrix::Error(headerFile, 0, "could not write");
+         }
+      }
+
+      if(!filterFile.empty())
+      {
+         std::ofstream out(filterFile.c_str());
+         matrix::writeFilters(out, std::cout, description);
+         if(!out)
+         {
+            throw matrix::Error(filterFile, 0, "could not write");
+         }
+      }
+
+      if(!blobFile.empty())
+      {
+         std::ofstream out(blobFile.c_str(), std::ios::binary);
+         uint16_t      crc = matrix::writeBlob(out, description, revision);
+         if(!out)
+         {
+            throw matrix::Error(blobFile, 0, "could not write");
+         }
+         std::cout << "EEPROM image: revision " << revision << ", CRC 0x"
+                   << std::hex << std::uppercase << crc << std::dec << "\n";
+      }
+
+      if(report)
+      {
+         matrix::writeReport(std::cout, description);
+      }
+   }
+   catch(const std::exception& e)
+   {
+      std::cerr << e.what() << "\n";
+      return 1;
+   }
+
+   return 0;
+}
@@ -0,0 +1,780 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file matrix.cpp
+ *
+ * \date Created: 16.10.2026 20:50:57
+ * \author agent
+ **/
+
+
+#include <cmath>
+#include <map>
+#include <sstream>
+
+#include "matrix.h"
+
+namespace matrix
+{
+
+/***************************************************************************/
+/* HELPERS                                                                 */
+/***************************************************************************/
+
+namespace
+{
+
+/**
+ * \brief convert number in decimal or hex (0x) notation
+ * \param text - number to convert
+ * \param value - converted value
+ * \return true, if text is a number
+ */
+bool toUnsigned(const std::string& text, unsigned& value)
+{
+   std::istringstream in(text);
+
+   if((text.size() > 2) && ('0' == text[0]) &&
+      (('x' == text[1]) || ('X' == text[1])))
+   {
+      in.ignore(2);
+      in >> std::hex;
+   }
+
+   in >> value;
+   return !in.fail() && in.eof();
+}
+
+/**
+ * \brief convert floating point number
+ * \param text - number to convert
+ * \param value - converted value
+ * \return true, if text is a number
+ */
+bool toDouble(const std::string& text, double& value)
+{
+   std::istringstream in(text);
+
+   in >> value;
+   return !in.fail() && in.eof();
+}
+
+/**
+ * \brief get bits occupied by a signal as mask of 64 message bits
+ * \param signal - signal to check
+ * \param dlc - data length of message
+ * \param mask - bits occupied
+ * \return false, if signal exceeds the data length
+ */
+bool bitsOf(const Signal& signal, unsigned dlc, uint64_t& mask)
+{
+   int      byte  = signal.start / 8;
+   unsigned bit   = signal.start % 8;
+   unsigned count = 0;
+
+   mask = 0;
+   while(count < signal.length)
+   {
+      if((byte < 0) || (byte >= static_cast<int>(dlc)))
+      {
+         return false;
+      }
+
+      mask |= static_cast<uint64_t>(1) << (byte * 8 + bit);
+      ++count;
+
+      if(8 == ++bit)
+      {
+         bit   = 0;
+         byte += (INTEL == signal.order) ? 1 : -1;
+      }
+   }
+
+   return true;
+}
+
+/**
+ * \brief find message by bus and name
+ * \param description - matrix description
+ * \param bus - bus number
+ * \param name - message name
+ * \param index - index of message found
+ * \return true, if found
+ */
+bool findMessage(const Description& description,
+                 unsigned           bus,
+                 const std::string& name,
+                 size_t&            index)
+{
+   for(index = 0; index < description.messages.size(); ++index)
+   {
+      if((description.messages[index].bus == bus) &&
+         (description.messages[index].name == name))
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+/**
+ * \brief resolve a signal reference "bus.MESSAGE.SIGNAL"
+ * \param description - matrix description
+ * \param text - reference to resolve
+ * \param line - line of description
+ * \return reference
+ * \throw Error, if not found
+ */
+SignalRef resolve(const Description& description,
+                  const std::string& text,
+                  unsigned           line)
+{
+   size_t    first  = text.find('.');
+   size_t    second = text.find('.', first + 1);
+   unsigned  bus;
+   SignalRef ref;
+
+   if((std::string::npos == first) || (std::string::npos == second) ||
+      !toUnsigned(text.substr(0, first), bus))
+   {
+      throw Error(description.fileName, line,
+                  "signal reference bus.MESSAGE.SIGNAL expected: " + text);
+   }
+
+   if(!findMessage(description, bus,
+                   text.substr(first + 1, second - first - 1), ref.message))
+   {
+      throw Error(description.fileName, line, "unknown message: " + text);
+   }
+
+   const std::vector<Signal>& signals =
+      description.messages[ref.message].signals;
+   for(ref.signal = 0; ref.signal < signals.size(); ++ref.signal)
+   {
+      if(signals[ref.signal].name == text.substr(second + 1))
+      {
+         return ref;
+      }
+   }
+
+   throw Error(description.fileName, line, "unknown signal: " + text);
+}
+
+/**
+ * \brief parse a signal definition
+ * \param description - matrix description
+ * \param fields - fields of line (without keyword)
+ * \param line - line of description
+ * \return signal
+ *
+ * Syntax: NAME start|length@order+/- (scale,offset) "unit"
+ */
+Signal parseSignal(const Description&              description,
+                   const std::vector<std::string>& fields,
+                   unsigned                        line)
+{
+   Signal      signal;
+   std::string position;
+   std::string conversion;
+   size_t      bar;
+   size_t      at;
+   size_t      comma;
+
+   if(fields.size() < 3)
+   {
+      throw Error(description.fileName, line,
+                  "SIG name start|length@order+ (scale,offset) \"unit\" expected");
+   }
+
+   signal.name  = fields[0];
+   signal.line  = line;
+   position     = fields[1];
+   conversion   = fields[2];
+   bar          = position.find('|');
+   at           = position.find('@');
+   comma        = conversion.find(',');
+
+   if((std::string::npos == bar) || (std::string::npos == at) ||
+      (at < bar) || (position.size() != at + 3) ||
+      !toUnsigned(position.substr(0, bar), signal.start) ||
+      !toUnsigned(position.substr(bar + 1, at - bar - 1), signal.length) ||
+      (('0' != position[at + 1]) && ('1' != position[at + 1])) ||
+      (('+' != position[at + 2]) && ('-' != position[at + 2])))
+   {
+      throw Error(description.fileName, line,
+                  "position start|length@order+ expected: " + position);
+   }
+
+   signal.order    = ('1' == position[at + 1]) ? INTEL : MOTOROLA;
+   signal.isSigned = ('-' == position[at + 2]);
+
+   if((conversion.size() < 5) || ('(' != conversion.front()) ||
+      (')' != conversion.back()) || (std::string::npos == comma) ||
+      !toDouble(conversion.substr(1, comma - 1), signal.scale) ||
+      !toDouble(conversion.substr(comma + 1, conversion.size() - comma - 2),
+                signal.offset))
+   {
+      throw Error(description.fileName, line,
+                  "conversion (scale,offset) expected: " + conversion);
+   }
+
+   if(fields.size() > 3)
+   {
+      signal.unit = fields[3];
+      if((signal.unit.size() < 2) || ('"' != signal.unit.front()) ||
+         ('"' != signal.unit.back()))
+      {
+         throw Error(description.fileName, line,
+                     "unit in quotes expected: " + signal.unit);
+      }
+      signal.unit = signal.unit.substr(1, signal.unit.size() - 2);
+   }
+
+   return signal;
+}
+
+/**
+ * \brief compute conversion of a routed signal
+ * \param description - matrix description
+ * \param route - route to compute factor, shift and offset for
+ * \throw Error, if the conversion is not possible with the firmware kernel
+ *
+ * dst_raw = ((src_raw * factor) >> shift) + offset with factor/2^shift as
+ * src_scale/dst_scale and offset as (src_offset - dst_offset)/dst_scale.
+ */
+void computeConversion(const Description& description, Route& route)
+{
+   const Signal& src   = signalOf(description, route.src);
+   const Signal& dst   = signalOf(description, route.dst);
+   double        ratio = src.scale / dst.scale;
+   double        offset;
+
+   if(src.isSigned || dst.isSigned)
+   {
+      throw Error(description.fileName, route.line,
+                  "signed signals are not supported by the firmware");
+   }
+
+   if(ratio <= 0.0)
+   {
+      throw Error(description.fileName, route.line,
+                  "scales of different sign cannot be converted");
+   }
+
+   // smallest shift giving an exact factor up to 255
+   for(route.shift = 0; route.shift < 32; ++route.shift)
+   {
+      double factor = std::ldexp(ratio, route.shift);
+      if(factor > 255.5)
+      {
+         break;
+      }
+      if((factor >= 0.5) &&
+         (std::fabs(factor - std::round(factor)) < 1e-9 * factor))
+      {
+         route.factor = static_cast<unsigned>(std::round(factor));
+         break;
+      }
+   }
+
+   if((32 == route.shift) || (std::ldexp(ratio, route.shift) > 255.5))
+   {
+      std::ostringstream text;
+      text << "scale ratio " << ratio
+           << " is no factor/2^shift with factor 1..255";
+      throw Error(description.fileName, route.line, text.str());
+   }
+
+   offset = (src.offset - dst.offset) / dst.scale;
+   if((std::fabs(offset - std::round(offset)) > 1e-6) ||
+      (offset < -32768.0) || (offset > 32767.0))
+   {
+      std::ostringstream text;
+      text << "offset " << offset << " is no 16bit integer of destination";
+      throw Error(description.fileName, route.line, text.str());
+   }
+   route.offset = static_cast<int>(std::round(offset));
+
+   // kernel multiplies 32bit
+   if(std::ldexp(static_cast<double>(route.factor), src.length) >
+      4294967296.0)
+   {
+      throw Error(description.fileName, route.line,
+                  "raw value times factor exceeds 32bit");
+   }
+}
+
+} // namespace
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief create error message with file name and line
+ * \param fileName - file of description
+ * \param line - line of description (0 - no line)
+ * \param text - what is wrong
+ */
+Error::Error(const std::string& fileName, unsigned line, const std::string& text)
+   : std::runtime_error(fileName + ":" +
+                        (line ? std::to_string(line) + ": " : std::string(" ")) +
+                        text)
+{
+}
+
+/**
+ * \brief get signal referenced
+ * \param description - matrix description
+ * \param ref - reference to signal
+ * \return signal
+ */
+const Signal& signalOf(const Description& description, const SignalRef& ref)
+{
+   return description.messages[ref.message].signals[ref.signal];
+}
+
+/**
+ * \brief get full name of signal, e.g. "1.WHEEL_GEAR_DATA.SPEED"
+ * \param description - matrix description
+ * \param ref - reference to signal
+ * \return name
+ */
+std::string nameOf(const Description& description, const SignalRef& ref)
+{
+   const Message& message = description.messages[ref.message];
+
+   return std::to_string(message.bus) + "." + message.name + "." +
+          message.signals[ref.signal].name;
+}
+
+/**
+ * \brief read a matrix description
+ * \param in - stream to read
+ * \param fileName - name of file for error messages
+ * \return description (not validated yet)
+ * \throw Error on syntax errors
+ *
+ * \code
+ * # comment
+ * MSG   bus id name dlc rx|tx handler
+ * SIG   name start|length@order+ (scale,offset) "unit"
+ * SEND  cyclic|change|arrival|cyclic+change cycle gap prio [bus.MESSAGE ...]
+ * WAKE
+ * ROUTE bus.MESSAGE.SIGNAL -> bus.MESSAGE.SIGNAL
+ * \endcode
+ * Order is 1 for Intel and 0 for Motorola, + unsigned and - signed. SEND
+ * follows each sent message: cycle and minimum gap between event driven
+ * sends are in ms, prio is low, normal, high or highest. Sources are the
+ * received messages triggering events besides the routed signals. WAKE
+ * follows a received message of CAN #1, which wakes the gateway from bus
+ * sleep.
+ */
+Description parse(std::istream& in, const std::string& fileName)
+{
+   Description              description;
+   std::vector<std::string> fields;
+   std::vector<std::string> routes;
+   std::vector<unsigned>    routeLines;
+   std::string              text;
+   std::string              field;
+   unsigned                 line = 0;
+
+   description.fileName = fileName;
+
+   while(std::getline(in, text))
+   {
+      ++line;
+      text = text.substr(0, text.find('#'));
+
+      std::istringstream words(text);
+      fields.clear();
+      while(words >> field)
+      {
+         fields.push_back(field);
+      }
+
+      if(fields.empty())
+      {
+         continue;
+      }
+
+      if("MSG" == fields[0])
+      {
+         Message message;
+
+         if((fields.size() != 7) ||
+            !toUnsigned(fields[1], message.bus) ||
+            !toUnsigned(fields[2], message.id) ||
+            !toUnsigned(fields[4], message.dlc) ||
+            (("rx" != fields[5]) && ("tx" != fields[5])))
+         {
+            throw Error(fileName, line,
+                        "MSG bus id name dlc rx|tx handler expected");
+         }
+
+         message.name     = fields[3];
+         message.received = ("rx" == fields[5]);
+         message.handler  = fields[6];
+         message.line     = line;
+         message.policy   = CYCLIC;
+         message.cycle    = 0;
+         message.gap      = 0;
+         message.sendLine = 0;
+         message.wake     = false;
+         description.messages.push_back(message);
+      }
+      else if("SEND" == fields[0])
+      {
+         const char* policies[] =
+            { "cyclic", "change", "arrival", "cyclic+change" };
+         unsigned    policy;
+
+         if(description.messages.empty() ||
+            description.messages.back().received ||
+            (0 != description.messages.back().sendLine))
+         {
+            throw Error(fileName, line, "SEND needs to follow a sent MSG");
+         }
+
+         Message& message = description.messages.back();
+
+         for(policy = 0; policy < 4; ++policy)
+         {
+            if((fields.size() > 1) && (policies[policy] == fields[1]))
+            {
+               break;
+            }
+         }
+
+         if((fields.size() < 5) || (4 == policy) ||
+            !toUnsigned(fields[2], message.cycle) ||
+            !toUnsigned(fields[3], message.gap))
+         {
+            throw Error(fileName, line,
+                        "SEND cyclic|change|arrival|cyclic+change cycle gap "
+                        "prio [sources] expected");
+         }
+
+         message.policy   = static_cast<TxPolicy>(policy);
+         message.prio     = fields[4];
+         message.sources.assign(fields.begin() + 5, fields.end());
+         message.sendLine = line;
+      }
+      else if("WAKE" == fields[0])
+      {
+         if(description.messages.empty() ||
+            !description.messages.back().received ||
+            (1 != description.messages.back().bus) ||
+            description.messages.back().wake || (fields.size() != 1))
+         {
+            throw Error(fileName, line,
+                        "WAKE needs to follow a received MSG of CAN #1");
+         }
+
+         description.messages.back().wake = true;
+      }
+      else if("SIG" == fields[0])
+      {
+         if(description.messages.empty())
+         {
+            throw Error(fileName, line, "SIG without MSG");
+         }
+
+         fields.erase(fields.begin());
+         description.messages.back().signals.push_back(
+            parseSignal(description, fields, line));
+      }
+      else if("ROUTE" == fields[0])
+      {
+         if((fields.size() != 4) || ("->" != fields[2]))
+         {
+            throw Error(fileName, line,
+                        "ROUTE bus.MESSAGE.SIGNAL -> bus.MESSAGE.SIGNAL expected");
+         }
+
+         // resolved after all messages are known
+         routes.push_back(fields[1]);
+         routes.push_back(fields[3]);
+         routeLines.push_back(line);
+      }
+      else
+      {
+         throw Error(fileName, line, "unknown keyword " + fields[0]);
+      }
+   }
+
+   for(size_t i = 0; i < routeLines.size(); ++i)
+   {
+      Route route;
+
+      route.src    = resolve(description, routes[2 * i], routeLines[i]);
+      route.dst    = resolve(description, routes[2 * i + 1], routeLines[i]);
+      route.factor = 1;
+      route.shift  = 0;
+      route.offset = 0;
+      route.line   = routeLines[i];
+      description.routes.push_back(route);
+   }
+
+   return description;
+}
+
+/**
+ * \brief check description and compute conversions of routed signals
+ * \param description - description to check
+ * \return warnings, e.g. values exceeding the destination signal
+ * \throw Error on any error
+ */
+std::vector<std::string> validate(Description& description)
+{
+   std::vector<std::string> warnings;
+   const std::string&       fileName = description.fileName;
+
+   for(size_t i = 0; i < description.messages.size(); ++i)
+   {
+      const Message& message = description.messages[i];
+      uint64_t       used    = 0;
+
+      if((message.bus < 1) || (message.bus > NUM_OF_BUSES))
+      {
+         throw Error(fileName, message.line, "bus 1 or 2 expected");
+      }
+      if(message.id > 0x7FF)
+      {
+         throw Error(fileName, message.line,
+                     "only standard frames (id <= 0x7FF) are supported");
+      }
+      if(message.dlc > 8)
+      {
+         throw Error(fileName, message.line, "data length 0..8 expected");
+      }
+
+      for(size_t j = 0; j < i; ++j)
+      {
+         const Message& other = description.messages[j];
+         if((other.bus == message.bus) &&
+            ((other.id == message.id) || (other.name == message.name)))
+         {
+            throw Error(fileName, message.line,
+                        "id or name already used in line " +
+                        std::to_string(other.line));
+         }
+      }
+
+      for(size_t j = 0; j < message.signals.size(); ++j)
+      {
+         const Signal& signal = message.signals[j];
+         uint64_t      bits;
+
+         if((0 == signal.length) || (signal.length > 32))
+         {
+            throw Error(fileName, signal.line, "length 1..32 expected");
+         }
+         if((signal.start > 63) || !bitsOf(signal, message.dlc, bits))
+         {
+            throw Error(fileName, signal.line,
+                        "signal " + signal.name + " exceeds data length");
+         }
+         if(0 != (used & bits))
+         {
+            throw Error(fileName, signal.line,
+                        "signal " + signal.name + " overlaps another signal");
+         }
+         if(0.0 == signal.scale)
+         {
+            throw Error(fileName, signal.line, "scale must not be 0");
+         }
+         for(size_t k = 0; k < j; ++k)
+         {
+            if(message.signals[k].name == signal.name)
+            {
+               throw Error(fileName, signal.line,
+                           "signal " + signal.name + " defined twice");
+            }
+         }
+         used |= bits;
+      }
+   }
+
+   for(unsigned bus = 1; bus <= NUM_OF_BUSES; ++bus)
+   {
+      unsigned count = 0;
+
+      for(size_t i = 0; i < description.messages.size(); ++i)
+      {
+         Message& message = description.messages[i];
+
+         if((message.bus != bus) || message.received)
+         {
+            continue;
+         }
+
+         if(++count > MAX_TX_MESSAGES)
+         {
+            throw Error(fileName, message.line,
+                        "more than " + std::to_string(MAX_TX_MESSAGES) +
+                        " messages sent on bus " + std::to_string(bus));
+         }
+         if(0 == message.sendLine)
+         {
+            throw Error(fileName, message.line,
+                        "SEND expected for " + message.name);
+         }
+         if((("low" != message.prio) && ("normal" != message.prio) &&
+             ("high" != message.prio) && ("highest" != message.prio)) ||
+            (message.cycle > MAX_CYCLE) || (message.gap > MAX_CYCLE))
+         {
+            throw Error(fileName, message.sendLine,
+                        "priority low|normal|high|highest and times up to " +
+                        std::to_string(MAX_CYCLE) + "ms expected");
+         }
+         if(((CYCLIC == message.policy) ||
+             (CYCLIC_ON_CHANGE == message.policy)) && (0 == message.cycle))
+         {
+            throw Error(fileName, message.sendLine,
+                        "cyclic message without cycle");
+         }
+
+         message.sourceIndices.clear();
+         for(size_t j = 0; j < message.sources.size(); ++j)
+         {
+            const std::string& source = message.sources[j];
+            size_t             dot    = source.find('.');
+            unsigned           srcBus;
+            size_t             index;
+
+            if((std::string::npos == dot) ||
+               !toUnsigned(source.substr(0, dot), srcBus) ||
+               !findMessage(description, srcBus, source.substr(dot + 1),
+                            index) ||
+               !description.messages[index].received || (srcBus == bus))
+            {
+               throw Error(fileName, message.sendLine,
+                           "message received on the other bus expected: " +
+                           source);
+            }
+            message.sourceIndices.push_back(index);
+         }
+      }
+   }
+
+   if(description.routes.size() > MAX_ROUTES)
+   {
+      throw Error(fileName, 0, "more than " + std::to_string(MAX_ROUTES) +
+                               " routed signals");
+   }
+
+   for(size_t i = 0; i < description.routes.size(); ++i)
+   {
+      Route&        route = description.routes[i];
+      const Signal& src   = signalOf(description, route.src);
+      const Signal& dst   = signalOf(description, route.dst);
+      double        max;
+
+      if(!description.messages[route.src.message].received ||
+         description.messages[route.dst.message].received ||
+         (description.messages[route.src.message].bus ==
+          description.messages[route.dst.message].bus))
+      {
+         throw Error(fileName, route.line,
+                     "route from a received to a sent message of the other "
+                     "bus expected");
+      }
+
+      for(size_t j = 0; j < i; ++j)
+      {
+         if((description.routes[j].dst.message == route.dst.message) &&
+            (description.routes[j].dst.signal == route.dst.signal))
+         {
+            throw Error(fileName, route.line,
+                        nameOf(description, route.dst) + " routed twice");
+         }
+      }
+
+      computeConversion(description, route);
+
+      // largest value of source after conversion
+      max = std::floor(std::ldexp(std::ldexp(1.0, src.length) - 1.0, 0) *
+                       route.factor / std::ldexp(1.0, route.shift)) +
+            route.offset;
+      if((max > std::ldexp(1.0, dst.length) - 1.0) || (route.offset < 0))
+      {
+         std::ostringstream text;
+         text << fileName << ":" << route.line << ": warning: "
+              << nameOf(description, route.dst)
+              << " wraps around for large/small values of "
+              << nameOf(description, route.src);
+         warnings.push_back(text.str());
+      }
+   }
+
+   return warnings;
+}
+
+/**
+ * \brief check ids of all messages against their definitions in C
+ * \param description - validated matrix description
+ * \param in - stream of header defining CANID_x_<name>, e.g. comm_can_ids.h
+ * \param fileName - name of header for error messages
+ * \throw Error, if a message is not defined or its id differs
+ *
+ * Only lines "#define CANID_x_<name> <id>" are evaluated.
+ */
+void checkIds(const Description& description,
+              std::istream&      in,
+              const std::string& fileName)
+{
+   std::map<std::string, unsigned> ids;
+   std::string                     text;
+
+   while(std::getline(in, text))
+   {
+      std::istringstream words(text);
+      std::string        define;
+      std::string        name;
+      std::string        value;
+      unsigned           id;
+
+      words >> define >> name >> value;
+      if(("#define" == define) && (0 == name.compare(0, 6, "CANID_")) &&
+         toUnsigned(value, id))
+      {
+         ids[name] = id;
+      }
+   }
+
+   for(size_t i = 0; i < description.messages.size(); ++i)
+   {
+      const Message& message = description.messages[i];
+      std::string    name    = "CANID_" + std::to_string(message.bus) + "_" +
+                               message.name;
+      std::map<std::string, unsigned>::const_iterator found = ids.find(name);
+
+      if(ids.end() == found)
+      {
+         throw Error(description.fileName, message.line,
+                     name + " is not defined in " + fileName);
+      }
+      if(found->second != message.id)
+      {
+         std::ostringstream text;
+         text << "id differs from " << name << " (0x" << std::hex
+              << std::uppercase << found->second << ") in " << fileName;
+         throw Error(description.fileName, message.line, text.str());
+      }
+   }
+}
+
+} // namespace matrix
@@ -0,0 +1,272 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file matrix.h
+ *
+ * Description of the CAN matrix as read by the matrix compiler: messages of
+ * both buses, their signals and the signals routed from one bus to the
+ * other.
+ *
+ * \date Created: 16.10.2026 20:50:57
+ * \author agent
+ **/
+
+
+#ifndef MATRIX_H_
+#define MATRIX_H_
+
+#include <cstdint>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace matrix
+{
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \brief number of CAN buses
+ */
+const unsigned NUM_OF_BUSES    = 2;
+
+/**
+ * \brief maximum number of sent messages per bus (bits of dirty mask)
+ */
+const unsigned MAX_TX_MESSAGES = 8;
+
+/**
+ * \brief maximum cycle and gap in ms (half range of sched_getTime())
+ */
+const unsigned MAX_CYCLE       = 8000;
+
+/**
+ * \brief maximum number of routed signals (COMM_MATRIX_MAX_SIGNALS)
+ */
+const unsigned MAX_ROUTES      = 8;
+
+/**
+ * \brief version of EEPROM layout (COMM_MATRIX_VERSION)
+ */
+const unsigned LAYOUT_VERSION  = 1;
+
+/***************************************************************************/
+/* TYPE DEFINITIONS                                                        */
+/***************************************************************************/
+
+/**
+ * \brief byte order of a signal (comm_signal_order_t)
+ */
+enum ByteOrder
+{
+   //! little endian
+   INTEL    = 0,
+   //! big endian
+   MOTOROLA = 1
+};
+
+/**
+ * \brief transmit policy of a sent message (comm_tx_policy_t)
+ */
+enum TxPolicy
+{
+   //! sent by its cycle only
+   CYCLIC           = 0,
+   //! sent, if its content changed (not before minimum gap)
+   ON_CHANGE        = 1,
+   //! sent, if a source message arrived (not before minimum gap)
+   ON_ARRIVAL       = 2,
+   //! sent by its cycle and immediately, if its content changed
+   CYCLIC_ON_CHANGE = 3
+};
+
+/**
+ * \brief signal within a message
+ *
+ * The start bit is the least significant bit (byte * 8 + bit) for both
+ * byte orders - other than in DBC files, where Motorola signals start at
+ * their most significant bit.
+ */
+struct Signal
+{
+   //! name, unique within message
+   std::string name;
+   //! least significant bit
+   unsigned    start;
+   //! length in bits
+   unsigned    length;
+   //! byte order
+   ByteOrder   order;
+   //! signed raw value
+   bool        isSigned;
+   //! physical value = raw * scale + offset
+   double      scale;
+   //! physical value = raw * scale + offset
+   double      offset;
+   //! unit of physical value
+   std::string unit;
+   //! line of description
+   unsigned    line;
+};
+
+/**
+ * \brief CAN message of a bus
+ */
+struct Message
+{
+   //! bus number (1..NUM_OF_BUSES)
+   unsigned            bus;
+   //! standard CAN id
+   unsigned            id;
+   //! name, unique within bus
+   std::string         name;
+   //! data length
+   unsigned            dlc;
+   //! received (true) or sent (false) by CAN2matrix
+   bool                received;
+   //! decoder or encoder function of firmware
+   std::string         handler;
+   //! signals of message
+   std::vector<Signal> signals;
+   //! line of description
+   unsigned            line;
+   //! transmit policy (sent messages only)
+   TxPolicy            policy;
+   //! cycle in ms (0 - none)
+   unsigned            cycle;
+   //! minimum gap between two event driven sends in ms
+   unsigned            gap;
+   //! priority of can_tx_send(): low, normal, high or highest
+   std::string         prio;
+   //! messages triggering an event driven send, e.g. "1.IGNITION"
+   std::vector<std::string> sources;
+   //! indices of source messages (resolved by validate())
+   std::vector<size_t> sourceIndices;
+   //! line of SEND (0 - none)
+   unsigned            sendLine;
+   //! wakes the gateway from bus sleep (received messages only)
+   bool                wake;
+};
+
+/**
+ * \brief reference to a signal of a message
+ */
+struct SignalRef
+{
+   //! index of message
+   size_t message;
+   //! index of signal within message
+   size_t signal;
+};
+
+/**
+ * \brief signal routed from a received to a sent message
+ */
+struct Route
+{
+   //! source signal
+   SignalRef src;
+   //! destination signal
+   SignalRef dst;
+   //! multiplier of raw value (comm_signal_t::factor)
+   unsigned  factor;
+   //! right shift after multiplication (comm_signal_t::shift)
+   unsigned  shift;
+   //! offset after scaling (comm_signal_t::offset)
+   int       offset;
+   //! line of description
+   unsigned  line;
+};
+
+/**
+ * \brief complete description of the matrix
+ */
+struct Description
+{
+   //! file name of description
+   std::string          fileName;
+   //! all messages of all buses
+   std::vector<Message> messages;
+   //! routed signals
+   std::vector<Route>   routes;
+};
+
+/**
+ * \brief error in description
+ */
+class Error : public std::runtime_error
+{
+public:
+   /**
+    * \brief create error message with file name and line
+    * \param fileName - file of description
+    * \param line - line of description (0 - no line)
+    * \param text - what is wrong
+    */
+   Error(const std::string& fileName, unsigned line, const std::string& text);
+};
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief read a matrix description
+ * \param in - stream to read
+ * \param fileName - name of file for error messages
+ * \return description (not validated yet)
+ * \throw Error on syntax errors
+ */
+Description parse(std::istream& in, const std::string& fileName);
+
+/**
+ * \brief check description and compute conversions of routed signals
+ * \param description - description to check
+ * \return warnings, e.g. values exceeding the destination signal
+ * \throw Error on any error
+ */
+std::vector<std::string> validate(Description& description);
+
+/**
+ * \brief check ids of all messages against their definitions in C
+ * \param description - validated matrix description
+ * \param in - stream of header defining CANID_x_<name>, e.g. comm_can_ids.h
+ * \param fileName - name of header for error messages
+ * \throw Error, if a message is not defined or its id differs
+ */
+void checkIds(const Description& description,
+              std::istream&      in,
+              const std::string& fileName);
+
+/**
+ * \brief get signal referenced
+ * \param description - matrix description
+ * \param ref - reference to signal
+ * \return signal
+ */
+const Signal& signalOf(const Description& description, const SignalRef& ref);
+
+/**
+ * \brief get full name of signal, e.g. "1.WHEEL_GEAR_DATA.SPEED"
+ * \param description - matrix description
+ * \param ref - reference to signal
+ * \return name
+ */
+std::string nameOf(const Description& description, const SignalRef& ref);
+
+} // namespace matrix
+
+#endif /* MATRIX_H_ */
@@ -0,0 +1,1004 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file output.cpp
+ *
+ * \date Created: 16.10.2026 20:50:57
+ * \author agent
+ **/
+
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <iomanip>
+#include <set>
+#include <sstream>
+
+#include "output.h"
+
+namespace matrix
+{
+
+/***************************************************************************/
+/* HELPERS                                                                 */
+/***************************************************************************/
+
+namespace
+{
+
+/**
+ * \brief estimated AVR cycles of the table driven parts (-Os, atmega8)
+ *
+ * Derived from comm_dispatch.h and comm_signal.c: compares of 16bit
+ * constants, LPM/LD of 16bit values, 32bit arithmetic done by 8bit
+ * instructions and calls with saving of registers.
+ */
+enum Cycles
+{
+   //! indirect call of handler selected by the switch
+   DISPATCH_CALL  = 15,
+   //! one level of the compare tree of the switch
+   DISPATCH_STEP  = 5,
+   //! compare of id per row of signal table
+   TABLE_ROW      = 10,
+   //! call of comm_signal_extract() and masking
+   EXTRACT_CALL   = 20,
+   //! each byte read by comm_signal_extract()
+   EXTRACT_BYTE   = 12,
+   //! 32bit multiplication, if factor is not 1
+   MULTIPLY       = 45,
+   //! each bit of 32bit right shift
+   SHIFT_BIT      = 8,
+   //! adding offset and storing value
+   STORE          = 16,
+   //! call of comm_signal_insert()
+   INSERT_CALL    = 25,
+   //! each byte written by comm_signal_insert()
+   INSERT_BYTE    = 18
+};
+
+/**
+ * \brief order of messages by id
+ */
+struct ById
+{
+   //! compare messages by id
+   bool operator()(const Message* a, const Message* b) const
+   {
+      return a->id < b->id;
+   }
+};
+
+/**
+ * \brief get messages of a bus sorted by id
+ * \param description - matrix description
+ * \param bus - bus number
+ * \param received - received or sent messages
+ * \return messages
+ */
+std::vector<const Message*> messagesOf(const Description& description,
+                                       unsigned           bus,
+                                       bool               received)
+{
+   std::vector<const Message*> messages;
+
+   for(size_t i = 0; i < description.messages.size(); ++i)
+   {
+      if((description.messages[i].bus == bus) &&
+         (description.messages[i].received == received))
+      {
+         messages.push_back(&description.messages[i]);
+      }
+   }
+
+   std::sort(messages.begin(), messages.end(), ById());
+   return messages;
+}
+
+/**
+ * \brief get received messages of a bus waking the gateway sorted by id
+ * \param description - matrix description
+ * \param bus - bus number
+ * \return messages
+ */
+std::vector<const Message*> wakeMessagesOf(const Description& description,
+                                           unsigned           bus)
+{
+   std::vector<const Message*> received = messagesOf(description, bus, true);
+   std::vector<const Message*> messages;
+
+   for(size_t i = 0; i < received.size(); ++i)
+   {
+      if(received[i]->wake)
+      {
+         messages.push_back(received[i]);
+      }
+   }
+
+   return messages;
+}
+
+/**
+ * \brief get name of id definition, e.g. CANID_1_IGNITION
+ * \param message - message
+ * \return name
+ */
+std::string idName(const Message& message)
+{
+   return "CANID_" + std::to_string(message.bus) + "_" + message.name;
+}
+
+/**
+ * \brief get number of bytes touched by a signal
+ * \param signal - signal
+ * \return bytes
+ */
+unsigned bytesOf(const Signal& signal)
+{
+   return ((signal.start % 8) + signal.length + 7) / 8;
+}
+
+/**
+ * \brief get number of levels of a compare tree (switch)
+ * \param size - number of entries
+ * \return levels
+ */
+unsigned stepsOf(size_t size)
+{
+   unsigned steps = 0;
+
+   while(0 != size)
+   {
+      size >>= 1;
+      ++steps;
+   }
+
+   return steps;
+}
+
+/**
+ * \brief write a multi line macro with aligned line continuations
+ * \param out - stream to write
+ * \param lines - lines of macro, first is "#define NAME"
+ */
+void writeMacro(std::ostream& out, const std::vector<std::string>& lines)
+{
+   for(size_t i = 0; i < lines.size(); ++i)
+   {
+      out << lines[i];
+      if(i + 1 < lines.size())
+      {
+         out << std::string((lines[i].size() < 68) ? 68 - lines[i].size() : 1,
+                            ' ')
+             << "\\";
+      }
+      out << "\n";
+   }
+}
+
+/**
+ * \brief get bit of a sent message in the dirty mask of its bus
+ * \param description - matrix description
+ * \param message - sent message
+ * \return bit (position in list of sent messages sorted by id)
+ */
+unsigned txBitOf(const Description& description, const Message* message)
+{
+   std::vector<const Message*> sent =
+      messagesOf(description, message->bus, false);
+
+   return std::find(sent.begin(), sent.end(), message) - sent.begin();
+}
+
+/**
+ * \brief get dirty mask of a message
+ * \param description - matrix description
+ * \param message - message
+ * \return bit of sent message or bits of messages to send on arrival
+ */
+unsigned dirtyOf(const Description& description, const Message* message)
+{
+   unsigned mask = 0;
+
+   if(!message->received)
+   {
+      return 1U << txBitOf(description, message);
+   }
+
+   for(size_t i = 0; i < description.messages.size(); ++i)
+   {
+      const Message& sent = description.messages[i];
+
+      for(size_t j = 0; j < sent.sourceIndices.size(); ++j)
+      {
+         if(&description.messages[sent.sourceIndices[j]] == message)
+         {
+            mask |= 1U << txBitOf(description, &sent);
+         }
+      }
+   }
+
+   for(size_t i = 0; i < description.routes.size(); ++i)
+   {
+      const Route& route = description.routes[i];
+
+      if(&description.messages[route.src.message] == message)
+      {
+         mask |= 1U << txBitOf(description,
+                               &description.messages[route.dst.message]);
+      }
+   }
+
+   return mask;
+}
+
+/**
+ * \brief write a list of ids, handlers and dirty masks as X macro
+ * \param out - stream to write
+ * \param description - matrix description
+ * \param messages - messages sorted by id
+ * \param list - name of list
+ */
+void writeList(std::ostream&                      out,
+               const Description&                 description,
+               const std::vector<const Message*>& messages,
+               const std::string&                 list)
+{
+   std::vector<std::string> lines(1, "#define " + list + "(X)");
+
+   for(size_t i = 0; i < messages.size(); ++i)
+   {
+      std::ostringstream line;
+      line << "   X(" << std::left << std::setw(30)
+           << (idName(*messages[i]) + ",") << std::setw(24)
+           << (messages[i]->handler + ",") << std::right << "0x" << std::hex
+           << std::uppercase << std::setw(2) << std::setfill('0')
+           << dirtyOf(description, messages[i]) << ")";
+      lines.push_back(line.str());
+   }
+
+   writeMacro(out, lines);
+}
+
+/**
+ * \brief get name of byte order in firmware
+ * \param order - byte order
+ * \return name of comm_signal_order_t
+ */
+const char* orderName(ByteOrder order)
+{
+   return (INTEL == order) ? "COMM_SIGNAL_INTEL" : "COMM_SIGNAL_MOTOROLA";
+}
+
+/**
+ * \brief write 16bit little endian value
+ * \param data - buffer to append
+ * \param value - value to write
+ */
+void put16(std::string& data, unsigned value)
+{
+   data += static_cast<char>(value & 0xFF);
+   data += static_cast<char>((value >> 8) & 0xFF);
+}
+
+/**
+ * \brief CRC16 as _crc16_update() of avr-libc (polynomial 0xA001)
+ * \param crc - CRC so far
+ * \param data - data to add
+ * \return new CRC
+ */
+uint16_t crc16(uint16_t crc, const std::string& data)
+{
+   for(size_t i = 0; i < data.size(); ++i)
+   {
+      crc ^= static_cast<uint8_t>(data[i]);
+      for(unsigned bit = 0; bit < 8; ++bit)
+      {
+         crc = (crc & 1) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+      }
+   }
+
+   return crc;
+}
+
+/**
+ * \brief standard ids (11bit)
+ */
+const unsigned ID_MASK  = 0x7FF;
+
+/**
+ * \brief number of standard ids
+ */
+const unsigned ID_SPACE = 0x800;
+
+/**
+ * \brief acceptance masks and filters of a MCP2515
+ */
+struct Cover
+{
+   //! RXM0, RXM1
+   unsigned              masks[2];
+   //! RXF0..RXF5, RXF0 and RXF1 belong to RXM0
+   std::vector<unsigned> filters;
+   //! all ids passing
+   std::vector<unsigned> accepted;
+};
+
+/**
+ * \brief write id as used in the generated headers, e.g. 0x271
+ * \param id - id
+ * \return text
+ */
+std::string hexOf(unsigned id)
+{
+   char text[8];
+
+   std::snprintf(text, sizeof(text), "0x%03X", id);
+   return text;
+}
+
+/**
+ * \brief write a list of ids separated by a separator
+ * \param ids - ids
+ * \param separator - separator
+ * \return text
+ */
+std::string hexOf(const std::vector<unsigned>& ids, const char* separator)
+{
+   std::string text;
+
+   for(size_t i = 0; i < ids.size(); ++i)
+   {
+      text += (0 == i) ? "" : separator;
+      text += hexOf(ids[i]);
+   }
+
+   return text;
+}
+
+/**
+ * \brief get number of bits set
+ * \param value - value
+ * \return bits
+ */
+unsigned popCount(unsigned value)
+{
+   unsigned count = 0;
+
+   while(0 != value)
+   {
+      count += value & 1;
+      value >>= 1;
+   }
+
+   return count;
+}
+
+/**
+ * \brief get best mask for a set of ids using up to a number of filters
+ * \param slots - number of filters of mask
+ * \param ids - ids to cover
+ * \param filters - filters found, empty if no mask fits
+ * \return mask
+ *
+ * The mask with the least number of ids passing wins, on equal number the
+ * one with more bits set.
+ */
+unsigned bestMask(unsigned                     slots,
+                  const std::vector<unsigned>& ids,
+                  std::vector<unsigned>&       filters)
+{
+   unsigned best     = ID_MASK;
+   long     bestCost = -1;
+
+   filters.clear();
+
+   for(unsigned mask = 0; mask <= ID_MASK; ++mask)
+   {
+      std::set<unsigned> patterns;
+
+      for(size_t i = 0; i < ids.size(); ++i)
+      {
+         patterns.insert(ids[i] & mask);
+      }
+      if(patterns.size() > slots)
+      {
+         continue;
+      }
+
+      long cost = patterns.size() * (1L << (11 - popCount(mask)));
+      if((bestCost < 0) || (cost < bestCost) ||
+         ((cost == bestCost) && (popCount(mask) > popCount(best))))
+      {
+         best     = mask;
+         bestCost = cost;
+         filters.assign(patterns.begin(), patterns.end());
+      }
+   }
+
+   return best;
+}
+
+/**
+ * \brief get best split of ids over RXM0 (RXF0, RXF1) and RXM1 (RXF2..RXF5)
+ * \param ids - ids to cover
+ * \return masks and filters with the least number of ids passing
+ *
+ * Nothing to cover accepts id 0 only (highest priority, not in use). Unused
+ * filters repeat the first filter of their mask, an empty set of a mask
+ * gets the full mask and the first id.
+ */
+Cover bestCover(const std::vector<unsigned>& ids)
+{
+   const unsigned slots[2] = { 2, 4 };
+   Cover          best;
+
+   if(ids.empty())
+   {
+      best.masks[0] = ID_MASK;
+      best.masks[1] = ID_MASK;
+      best.filters.assign(6, 0);
+      best.accepted.assign(1, 0);
+      return best;
+   }
+
+   for(unsigned split = 0; split < (1U << ids.size()); ++split)
+   {
+      std::vector<unsigned> sets[2];
+      std::vector<unsigned> filters[2];
+      Cover                 cover;
+      bool                  fits = true;
+
+      for(size_t i = 0; i < ids.size(); ++i)
+      {
+         sets[(split & (1U << i)) ? 0 : 1].push_back(ids[i]);
+      }
+
+      for(unsigned k = 0; k < 2; ++k)
+      {
+         if(sets[k].empty())
+         {
+            cover.masks[k] = ID_MASK;
+            filters[k].assign(1, ids[0]);
+         }
+         else
+         {
+            cover.masks[k] = bestMask(slots[k], sets[k], filters[k]);
+            fits           = fits && !filters[k].empty();
+         }
+      }
+      if(!fits)
+      {
+         continue;
+      }
+
+      // exact number of ids passing (both masks may overlap)
+      for(unsigned id = 0; id < ID_SPACE; ++id)
+      {
+         bool passes = false;
+
+         for(unsigned k = 0; (k < 2) && !passes; ++k)
+         {
+            for(size_t i = 0; (i < filters[k].size()) && !passes; ++i)
+            {
+               passes = ((id & cover.masks[k]) ==
+                         (filters[k][i] & cover.masks[k]));
+            }
+         }
+         if(passes)
+         {
+            cover.accepted.push_back(id);
+         }
+      }
+
+      if(best.accepted.empty() ||
+         (cover.accepted.size() < best.accepted.size()))
+      {
+         for(unsigned k = 0; k < 2; ++k)
+         {
+            filters[k].resize(slots[k], filters[k][0]);
+            cover.filters.insert(cover.filters.end(), filters[k].begin(),
+                                 filters[k].end());
+         }
+         best = cover;
+      }
+   }
+
+   return best;
+}
+
+/**
+ * \brief get ids of messages sorted by id
+ * \param messages - messages
+ * \return ids
+ */
+std::vector<unsigned> idsOf(const std::vector<const Message*>& messages)
+{
+   std::vector<unsigned> ids;
+
+   for(size_t i = 0; i < messages.size(); ++i)
+   {
+      ids.push_back(messages[i]->id);
+   }
+
+   return ids;
+}
+
+} // namespace
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief write C header with ids, dispatch lists and signal table
+ * \param out - stream to write
+ * \param description - validated matrix description
+ *
+ * The header includes comm_can_ids.h for the ids and defines the lists
+ * CANID_x_CONSUMED/CANID_x_PRODUCED/CANID_x_WAKE sorted by id and
+ * COMM_MATRIX_SIGNALS as initializer of the default signal table.
+ */
+void writeHeader(std::ostream& out, const Description& description)
+{
+   std::string              source = description.fileName;
+   std::vector<std::string> lines;
+
+   source = source.substr(source.find_last_of("/\\") + 1);
+
+   out << "/**\n"
+       << " * \\file comm_matrix_gen.h\n"
+       << " *\n"
+       << " * Generated by tools/matrix_compiler from " << source
+       << " - do not edit!\n"
+       << " **/\n\n"
+       << "#ifndef COMM_MATRIX_GEN_H_\n"
+       << "#define COMM_MATRIX_GEN_H_\n\n"
+       << "#include \"comm_can_ids.h\"\n\n";
+
+   out << "/**\n"
+       << " * \\addtogroup matrix_can_ids_registry CAN IDs Handled by The Matrix\n"
+       << " * \\brief CAN ids received or sent together with their handlers\n"
+       << " *\n"
+       << " * Each list entry is X(id, handler, dirty). The lists are expanded into\n"
+       << " * the cases of the dispatch switches of comm_matrix.c and are sorted by\n"
+       << " * ascending id for readability. dirty is the mask of sent messages\n"
+       << " * depending on a consumed one (see comm_tx_markDirty()) or the bit of a\n"
+       << " * produced message. The acceptance masks and filters in\n"
+       << " * can_io/can_filter_config.h are generated from the same messages by\n"
+       << " * tools/matrix_compiler. The ids are the ones of comm_can_ids.h, the\n"
+       << " * matrix compiler checks its description against them.\n"
+       << " *\n"
+       << " * @{\n"
+       << " */\n\n";
+
+
+   for(unsigned bus = 1; bus <= NUM_OF_BUSES; ++bus)
+   {
+      std::string prefix = "CANID_" + std::to_string(bus);
+
+      out << "/**\n"
+          << " * \\def " << prefix << "_CONSUMED\n"
+          << " * \\brief CAN ids evaluated on CAN #" << bus
+          << " and their decoders\n"
+          << " *\n"
+          << " * \\def " << prefix << "_PRODUCED\n"
+          << " * \\brief CAN ids sent on CAN #" << bus
+          << " and their encoders\n"
+          << " *\n"
+          << " * \\def " << prefix << "_WAKE\n"
+          << " * \\brief consumed CAN ids waking the gateway on CAN #" << bus
+          << "\n"
+          << " */\n";
+      writeList(out, description, messagesOf(description, bus, true),
+                prefix + "_CONSUMED");
+      writeList(out, description, messagesOf(description, bus, false),
+                prefix + "_PRODUCED");
+      writeList(out, description, wakeMessagesOf(description, bus),
+                prefix + "_WAKE");
+      out << "\n";
+   }
+
+   out << "/*! @} */\n\n";
+
+   out << "/**\n"
+       << " * \\addtogroup matrix_signals Signals of The Matrix\n"
+       << " * \\brief data length of messages and position of their signals\n"
+       << " *\n"
+       << " * A signal is described as start, length, order, dlc for use with\n"
+       << " * COMM_CODEC_GET() and COMM_CODEC_SET() of comm_codec.h.\n"
+       << " *\n"
+       << " * @{\n"
+       << " */\n\n";
+
+   for(size_t i = 0; i < description.messages.size(); ++i)
+   {
+      const Message& message = description.messages[i];
+      std::string    dlc     = "COMM_DLC_" + std::to_string(message.bus) +
+                               "_" + message.name;
+
+      out << "#define " << std::left << std::setw(47) << dlc << std::right
+          << message.dlc << "\n";
+
+      for(size_t j = 0; j < message.signals.size(); ++j)
+      {
+         const Signal& signal = message.signals[j];
+
+         out << "#define " << std::left << std::setw(47)
+             << ("COMM_SIG_" + std::to_string(message.bus) + "_" +
+                 message.name + "_" + signal.name)
+             << std::right << signal.start << ", " << signal.length << ", "
+             << orderName(signal.order) << ", " << dlc;
+         if((1.0 != signal.scale) || (0.0 != signal.offset) ||
+            !signal.unit.empty())
+         {
+            out << " /* (" << signal.scale << "," << signal.offset << ") "
+                << signal.unit << " */";
+         }
+         out << "\n";
+      }
+      out << "\n";
+   }
+
+   out << "/*! @} */\n\n";
+
+   out << "/**\n"
+       << " * \\addtogroup matrix_tx Transmit Policies of The Matrix\n"
+       << " * \\brief rows of comm_tx_t for each bus sending messages\n"
+       << " *\n"
+       << " * Rows are in the order of CANID_x_PRODUCED, COMM_TX_BIT_x_... is the bit\n"
+       << " * of a message in the dirty mask of its bus, COMM_TX_COUNT_x the number\n"
+       << " * of rows.\n"
+       << " *\n"
+       << " * @{\n"
+       << " */\n\n";
+
+   for(unsigned bus = 1; bus <= NUM_OF_BUSES; ++bus)
+   {
+      std::vector<const Message*> sent = messagesOf(description, bus, false);
+      const char* policies[] = { "COMM_TX_CYCLIC", "COMM_TX_ON_CHANGE",
+                                 "COMM_TX_ON_ARRIVAL",
+                                 "COMM_TX_CYCLIC_ON_CHANGE" };
+
+      if(sent.empty())
+      {
+         continue;
+      }
+
+      for(size_t i = 0; i < sent.size(); ++i)
+      {
+         out << "#define " << std::left << std::setw(47)
+             << ("COMM_TX_BIT_" + std::to_string(bus) + "_" + sent[i]->name)
+             << std::right << "(1 << " << i << ")\n";
+      }
+      out << "#define " << std::left << std::setw(47)
+          << ("COMM_TX_COUNT_" + std::to_string(bus))
+          << std::right << sent.size() << "\n";
+      out << "\n";
+
+      lines.assign(1, "#define COMM_MATRIX_TX_" + std::to_string(bus));
+      for(size_t i = 0; i < sent.size(); ++i)
+      {
+         std::string        prio = sent[i]->prio;
+         std::ostringstream first;
+         std::ostringstream second;
+
+         std::transform(prio.begin(), prio.end(), prio.begin(), ::toupper);
+         first << "   { " << idName(*sent[i]) << ", "
+               << policies[sent[i]->policy] << ", CAN_TX_PRIO_" << prio << ",";
+         second << "     SCHED_MS2TIME(" << sent[i]->cycle << "), SCHED_MS2TIME("
+                << sent[i]->gap << ") },";
+         lines.push_back(first.str());
+         lines.push_back(second.str());
+      }
+      writeMacro(out, lines);
+      out << "\n";
+   }
+
+   out << "/*! @} */\n\n";
+   lines.clear();
+
+   out << "/**\n"
+       << " * \\def COMM_MATRIX_SIGNALS\n"
+       << " * \\brief rows of comm_signal_t routed from CAN1 to CAN2\n"
+       << " *\n"
+       << " * dst = ((src * factor) >> shift) + offset\n"
+       << " */\n";
+
+   lines.push_back("#define COMM_MATRIX_SIGNALS");
+   for(size_t i = 0; i < description.routes.size(); ++i)
+   {
+      const Route&       route  = description.routes[i];
+      const Signal&      src    = signalOf(description, route.src);
+      const Signal&      dst    = signalOf(description, route.dst);
+      std::ostringstream first;
+      std::ostringstream second;
+
+      first << "   { " << idName(description.messages[route.src.message])
+            << ", " << src.start << ", " << src.length << ", "
+            << orderName(src.order) << ", " << route.factor << ", "
+            << route.shift << ", " << route.offset << ",";
+      second << "     " << idName(description.messages[route.dst.message])
+             << ", " << dst.start << ", " << dst.length << ", "
+             << orderName(dst.order) << " },";
+
+      lines.push_back("   /* " + nameOf(description, route.src) + " -> " +
+                      nameOf(description, route.dst) + " */");
+      lines.push_back(first.str());
+      lines.push_back(second.str());
+   }
+   writeMacro(out, lines);
+
+   out << "\n#endif /* COMM_MATRIX_GEN_H_ */\n";
+}
+
+/**
+ * \brief write C header with acceptance masks and filters of the MCP2515
+ * \param out - stream to write
+ * \param log - stream to report masks, filters and ids passing
+ * \param description - validated matrix description
+ *
+ * The masks and filters of each bus cover its received messages with the
+ * least number of other ids passing. The ones set while sleeping cover the
+ * messages waking the gateway, any id passes, if there are none.
+ */
+void writeFilters(std::ostream&      out,
+                  std::ostream&      log,
+                  const Description& description)
+{
+   std::string source = description.fileName;
+
+   source = source.substr(source.find_last_of("/\\") + 1);
+
+   out << "/**\n"
+       << " * \\file can_filter_config.h\n"
+       << " *\n"
+       << " * Generated by tools/matrix_compiler from " << source
+       << " - do not edit!\n"
+       << " *\n"
+       << " * Masks and filters cover all consumed ids with the least number\n"
+       << " * of other ids passing.\n"
+       << " **/\n\n"
+       << "#ifndef CAN_FILTER_CONFIG_H_\n"
+       << "#define CAN_FILTER_CONFIG_H_\n\n";
+
+   for(unsigned bus = 1; bus <= NUM_OF_BUSES; ++bus)
+   {
+      std::vector<const Message*> consumed = messagesOf(description, bus, true);
+      std::vector<const Message*> waking   = wakeMessagesOf(description, bus);
+      std::vector<unsigned>       ids      = idsOf(consumed);
+      Cover                       cover    = bestCover(ids);
+      Cover                       wake;
+      std::vector<unsigned>       unwanted;
+
+      for(size_t i = 0; i < cover.accepted.size(); ++i)
+      {
+         if(ids.end() == std::find(ids.begin(), ids.end(), cover.accepted[i]))
+         {
+            unwanted.push_back(cover.accepted[i]);
+         }
+      }
+
+      log << "CAN" << bus << ": " << ids.size() << " ids consumed, "
+          << cover.accepted.size() << " accepted by filters, "
+          << unwanted.size() << " unwanted\n"
+          << "CAN" << bus << ": RXM0 " << hexOf(cover.masks[0]) << " RXM1 "
+          << hexOf(cover.masks[1]) << "\n"
+          << "CAN" << bus << ": RXF0..5 " << hexOf(cover.filters, " ") << "\n";
+
+      for(size_t i = 0; i < description.messages.size(); ++i)
+      {
+         const Message& message = description.messages[i];
+
+         if((message.bus == bus) && !message.received &&
+            (unwanted.end() !=
+             std::find(unwanted.begin(), unwanted.end(), message.id)))
+         {
+            log << "CAN" << bus << ": known id " << idName(message) << " ("
+                << hexOf(message.id) << ") passes the filters\n";
+         }
+      }
+
+      out << "/**\n"
+          << " * \\def CAN_FILTER_CHIP" << bus << "_MASKS\n"
+          << " * \\brief RXM0, RXM1 of CAN #" << bus << "\n"
+          << " *\n"
+          << " * \\def CAN_FILTER_CHIP" << bus << "_FILTERS\n"
+          << " * \\brief RXF0..RXF5 of CAN #" << bus << "\n"
+          << " *\n"
+          << " * \\def CAN_FILTER_CHIP" << bus << "_UNWANTED\n"
+          << " * \\brief number of ids accepted, but not consumed on CAN #"
+          << bus << "\n"
+          << " *\n"
+          << " * Consumed:\n";
+      for(size_t i = 0; i < consumed.size(); ++i)
+      {
+         out << " * - " << idName(*consumed[i]) << "\n";
+      }
+      out << (consumed.empty() ? " * - none\n" : "")
+          << " */\n"
+          << "#define CAN_FILTER_CHIP" << bus << "_MASKS      "
+          << hexOf(cover.masks[0]) << ", " << hexOf(cover.masks[1]) << "\n"
+          << "#define CAN_FILTER_CHIP" << bus << "_FILTERS    "
+          << hexOf(cover.filters, ", ") << "\n"
+          << "#define CAN_FILTER_CHIP" << bus << "_UNWANTED   "
+          << unwanted.size() << "\n\n";
+
+      // while sleeping - without wake ids any frame wakes the gateway
+      if(waking.empty())
+      {
+         wake.masks[0] = 0;
+         wake.masks[1] = 0;
+         wake.filters.assign(6, 0);
+         wake.accepted.resize(ID_SPACE);
+      }
+      else
+      {
+         wake = bestCover(idsOf(waking));
+      }
+
+      log << "CAN" << bus << ": " << waking.size() << " wake ids, "
+          << wake.accepted.size() << " ids accepted while sleeping\n";
+
+      out << "/**\n"
+          << " * \\def CAN_FILTER_CHIP" << bus << "_WAKE_MASKS\n"
+          << " * \\brief RXM0, RXM1 of CAN #" << bus << " while sleeping\n"
+          << " *\n"
+          << " * \\def CAN_FILTER_CHIP" << bus << "_WAKE_FILTERS\n"
+          << " * \\brief RXF0..RXF5 of CAN #" << bus << " while sleeping\n"
+          << " *\n"
+          << " * Waking:\n";
+      for(size_t i = 0; i < waking.size(); ++i)
+      {
+         out << " * - " << idName(*waking[i]) << "\n";
+      }
+      out << (waking.empty() ? " * - any id\n" : "")
+          << " */\n"
+          << "#define CAN_FILTER_CHIP" << bus << "_WAKE_MASKS   "
+          << hexOf(wake.masks[0]) << ", " << hexOf(wake.masks[1]) << "\n"
+          << "#define CAN_FILTER_CHIP" << bus << "_WAKE_FILTERS "
+          << hexOf(wake.filters, ", ") << "\n\n";
+   }
+
+   out << "#endif /* CAN_FILTER_CONFIG_H_ */\n";
+}
+
+/**
+ * \brief write EEPROM image of routed signals
+ * \param out - binary stream to write
+ * \param description - validated matrix description
+ * \param revision - revision of matrix content (comm_matrix_header_t)
+ * \return CRC of image
+ *
+ * Layout is comm_matrix_header_t followed by packed comm_signal_t, all
+ * little endian as on the AVR.
+ */
+uint16_t writeBlob(std::ostream&      out,
+                   const Description& description,
+                   unsigned           revision)
+{
+   std::string header;
+   std::string rows;
+   uint16_t    crc;
+
+   if(description.routes.empty())
+   {
+      throw Error(description.fileName, 0,
+                  "no routed signals for the EEPROM image");
+   }
+
+   header += static_cast<char>(LAYOUT_VERSION);
+   header += static_cast<char>(description.routes.size());
+   put16(header, revision);
+
+   for(size_t i = 0; i < description.routes.size(); ++i)
+   {
+      const Route&  route = description.routes[i];
+      const Signal& src   = signalOf(description, route.src);
+      const Signal& dst   = signalOf(description, route.dst);
+
+      put16(rows, description.messages[route.src.message].id);
+      rows += static_cast<char>(src.start);
+      rows += static_cast<char>(src.length);
+      rows += static_cast<char>(src.order);
+      rows += static_cast<char>(route.factor);
+      rows += static_cast<char>(route.shift);
+      put16(rows, static_cast<unsigned>(route.offset) & 0xFFFF);
+      put16(rows, description.messages[route.dst.message].id);
+      rows += static_cast<char>(dst.start);
+      rows += static_cast<char>(dst.length);
+      rows += static_cast<char>(dst.order);
+   }
+
+   crc = crc16(crc16(0xFFFF, header), rows);
+   put16(header, crc);
+
+   out << header << rows;
+   return crc;
+}
+
+/**
+ * \brief write estimated cycles for decoding and encoding each message
+ * \param out - stream to write
+ * \param description - validated matrix description
+ *
+ * Covers the table driven part only (dispatch and signal kernel), not the
+ * code of hand written handlers.
+ */
+void writeReport(std::ostream& out, const Description& description)
+{
+   size_t rows = description.routes.size();
+
+   out << "bus id    message                  dir signals cycles     time\n";
+
+   for(unsigned bus = 1; bus <= NUM_OF_BUSES; ++bus)
+   {
+      for(int received = 1; received >= 0; --received)
+      {
+         std::vector<const Message*> messages =
+            messagesOf(description, bus, (1 == received));
+
+         for(size_t i = 0; i < messages.size(); ++i)
+         {
+            unsigned cycles  = DISPATCH_CALL +
+                               DISPATCH_STEP * stepsOf(messages.size());
+            unsigned signals = 0;
+
+            for(size_t j = 0; j < rows; ++j)
+            {
+               const Route& route = description.routes[j];
+               const SignalRef& ref = received ? route.src : route.dst;
+
+               if(&description.messages[ref.message] != messages[i])
+               {
+                  continue;
+               }
+
+               ++signals;
+               if(received)
+               {
+                  cycles += EXTRACT_CALL +
+                            EXTRACT_BYTE * bytesOf(signalOf(description, ref)) +
+                            ((1 != route.factor) ? MULTIPLY : 0) +
+                            SHIFT_BIT * route.shift + STORE;
+               }
+               else
+               {
+                  cycles += INSERT_CALL +
+                            INSERT_BYTE * bytesOf(signalOf(description, ref));
+               }
+            }
+
+            // the signal table is scanned by messages with routed signals
+            if(0 != signals)
+            {
+               cycles += TABLE_ROW * rows;
+            }
+
+            out << std::setw(3) << bus << " 0x" << std::hex << std::uppercase
+                << std::setw(3) << std::setfill('0') << messages[i]->id
+                << std::dec << std::nouppercase << std::setfill(' ') << "  "
+                << std::left << std::setw(24) << messages[i]->name
+                << std::right << " " << (received ? "rx " : "tx ")
+                << std::setw(8) << signals << std::setw(7) << cycles
+                << std::setw(7) << (cycles + CPU_CLOCK_MHZ - 1) / CPU_CLOCK_MHZ
+                << "us\n";
+         }
+      }
+   }
+
+   out << "(dispatch and signal kernel only, hand written handlers excluded)\n";
+}
+
+} // namespace matrix
@@ -0,0 +1,99 @@
+/**
+ * ----------------------------------------------------------------------------
+ *
+ * "THE ANY BEVERAGE-WARE LICENSE" (Revision 42 - based on beer-ware license):
+ * <dev@layer128.net> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a be(ve)er(age) in return. (I don't
+ * like beer much.)
+ *
+ * Matthias Kleemann
+ *
+ * ----------------------------------------------------------------------------
+ *
+ * \file output.h
+ *
+ * Outputs of the matrix compiler: generated C headers for the firmware,
+ * EEPROM image of the routed signals and an estimation of the run time.
+ *
+ * \date Created: 16.10.2026 20:50:57
+ * \author agent
+ **/
+
+
+#ifndef OUTPUT_H_
+#define OUTPUT_H_
+
+#include <ostream>
+#include <string>
+
+#include "matrix.h"
+
+namespace matrix
+{
+
+/***************************************************************************/
+/* DEFINITIONS                                                             */
+/***************************************************************************/
+
+/**
+ * \brief CPU clock of CAN2matrix to convert cycles into time
+ */
+const unsigned CPU_CLOCK_MHZ = 4;
+
+/***************************************************************************/
+/* FUNCTIONS                                                               */
+/***************************************************************************/
+
+/**
+ * \brief write C header with ids, dispatch lists and signal table
+ * \param out - stream to write
+ * \param description - validated matrix description
+ *
+ * The header includes comm_can_ids.h for the ids and defines the lists
+ * CANID_x_CONSUMED/CANID_x_PRODUCED/CANID_x_WAKE sorted by id and
+ * COMM_MATRIX_SIGNALS as initializer of the default signal table.
+ */
+void writeHeader(std::ostream& out, const Description& description);
+
+/**
+ * \brief write C header with acceptance masks and filters of the MCP2515
+ * \param out - stream to write
+ * \param log - stream to report masks, filters and ids passing
+ * \param description - validated matrix description
+ *
+ * The masks and filters of each bus cover its received messages with the
+ * least number of other ids passing. The ones set while sleeping cover the
+ * messages waking the gateway, any id passes, if there are none.
+ */
+void writeFilters(std::ostream&      out,
+                  std::ostream&      log,
+                  const Description& description);
+
+/**
+ * \brief write EEPROM image of routed signals
+ * \param out - binary stream to write
+ * \param description - validated matrix description
+ * \param revision - revision of matrix content (comm_matrix_header_t)
+ * \return CRC of image
+ *
+ * Layout is comm_matrix_header_t followed by packed comm_signal_t, all
+ * little endian as on the AVR.
+ */
+uint16_t writeBlob(std::ostream&      out,
+                   const Description& description,
+                   unsigned           revision);
+
+/**
+ * \brief write estimated cycles for decoding and encoding each message
+ * \param out - stream to write
+ * \param description - validated matrix description
+ *
+ * Covers the table driven part only (dispatch and signal kernel), not the
+ * code of hand written handlers.
+ */
+void writeReport(std::ostream& out, const Description& description);
+
+} // namespace matrix
+
+#endif /* OUTPUT_H_ */